@@ -80,7 +80,10 @@ static void group_add                   (EelCanvasGroup *group,
         EelCanvasItem  *item);
 static void group_remove                (EelCanvasGroup *group,
         EelCanvasItem  *item);
+static void group_grid_update           (EelCanvasGroup *group,
+        EelCanvasItem  *item);
 static void redraw_and_repick_if_mapped (EelCanvasItem *item);
+static void flush_damage                (EelCanvas      *canvas);
 
 /*** EelCanvasItem ***/
 
@@ -447,6 +450,10 @@ eel_canvas_item_invoke_update (EelCanvasItem *item,
     {
         if (EEL_CANVAS_ITEM_GET_CLASS (item)->update)
             EEL_CANVAS_ITEM_GET_CLASS (item)->update (item, i2w_dx, i2w_dy, child_flags);
+
+        /* The bounds may have changed, move the item in its parent's grid */
+        if (item->parent)
+            group_grid_update (EEL_CANVAS_GROUP (item->parent), item);
     }
 
     /* If this fail you probably forgot to chain up to
@@ -611,6 +618,9 @@ put_item_after (GList *link, GList *before)
         else
             parent->item_list_end = link;
     }
+
+    parent->grid_serials_valid = FALSE;
+
     return TRUE;
 }
 
@@ -1392,6 +1402,319 @@ eel_canvas_group_get_property (GObject *gobject, guint param_id,
     }
 }
 
+/* Children of large groups are kept in a grid of square cells, in canvas
+ * pixels, so that drawing and picking only look at the children that may
+ * overlap the area in question instead of walking the whole child list.
+ */
+#define GROUP_GRID_CELL_SIZE 256
+
+/* Children spanning more cells than this are returned by every lookup */
+#define GROUP_GRID_MAX_ITEM_CELLS 64
+
+/* Lookups covering more cells than this walk the child list instead */
+#define GROUP_GRID_MAX_QUERY_CELLS 1024
+
+/* Groups with fewer children than this always walk the child list */
+#define GROUP_GRID_MIN_ITEMS 64
+
+typedef struct
+{
+    gint64 key;
+    GPtrArray *entries;
+} GroupGridCell;
+
+typedef struct
+{
+    EelCanvasItem *item;
+
+    /* Bounds the item was indexed with, and the matching cells */
+    double x1, y1, x2, y2;
+    int cx1, cy1, cx2, cy2;
+    gboolean oversized;
+
+    /* Position in the stacking order, valid if grid_serials_valid */
+    guint serial;
+    /* Last lookup the item was returned by, to weed out duplicates */
+    guint stamp;
+} GroupGridEntry;
+
+static gint64
+group_grid_key (int cx, int cy)
+{
+    return ((gint64) cx << 32) | (guint32) cy;
+}
+
+/* Computes the cells covered by a rectangle in canvas pixels. Returns
+ * FALSE if there are more than max_cells of them.
+ */
+static gboolean
+group_grid_cell_range (double x1, double y1, double x2, double y2,
+                       int max_cells,
+                       int *cx1, int *cy1, int *cx2, int *cy2)
+{
+    double fx1, fy1, fx2, fy2;
+
+    fx1 = floor (MIN (x1, x2) / GROUP_GRID_CELL_SIZE);
+    fy1 = floor (MIN (y1, y2) / GROUP_GRID_CELL_SIZE);
+    fx2 = floor (MAX (x1, x2) / GROUP_GRID_CELL_SIZE);
+    fy2 = floor (MAX (y1, y2) / GROUP_GRID_CELL_SIZE);
+
+    /* Written so that bounds out of range or NaN fail too */
+    if (!(fx1 >= G_MININT && fy1 >= G_MININT &&
+            fx2 <= G_MAXINT && fy2 <= G_MAXINT &&
+            (fx2 - fx1 + 1) * (fy2 - fy1 + 1) <= max_cells))
+        return FALSE;
+
+    *cx1 = fx1;
+    *cy1 = fy1;
+    *cx2 = fx2;
+    *cy2 = fy2;
+
+    return TRUE;
+}
+
+static void
+group_grid_cell_free (gpointer data)
+{
+    GroupGridCell *cell;
+
+    cell = data;
+    g_ptr_array_free (cell->entries, TRUE);
+    g_free (cell);
+}
+
+static void
+group_grid_link (EelCanvasGroup *group, GroupGridEntry *entry)
+{
+    EelCanvasItem *item;
+    GroupGridCell *cell;
+    gint64 key;
+    int cx, cy;
+
+    item = entry->item;
+
+    entry->x1 = item->x1;
+    entry->y1 = item->y1;
+    entry->x2 = item->x2;
+    entry->y2 = item->y2;
+
+    entry->oversized = !group_grid_cell_range (item->x1, item->y1, item->x2, item->y2,
+                       GROUP_GRID_MAX_ITEM_CELLS,
+                       &entry->cx1, &entry->cy1,
+                       &entry->cx2, &entry->cy2);
+    if (entry->oversized)
+    {
+        g_hash_table_add (group->grid_oversized, entry);
+        return;
+    }
+
+    for (cy = entry->cy1; cy <= entry->cy2; cy++)
+        for (cx = entry->cx1; cx <= entry->cx2; cx++)
+        {
+            key = group_grid_key (cx, cy);
+            cell = g_hash_table_lookup (group->grid_cells, &key);
+            if (cell == NULL)
+            {
+                cell = g_new (GroupGridCell, 1);
+                cell->key = key;
+                cell->entries = g_ptr_array_new ();
+                g_hash_table_insert (group->grid_cells, &cell->key, cell);
+            }
+            g_ptr_array_add (cell->entries, entry);
+        }
+}
+
+static void
+group_grid_unlink (EelCanvasGroup *group, GroupGridEntry *entry)
+{
+    GroupGridCell *cell;
+    gint64 key;
+    int cx, cy;
+
+    if (entry->oversized)
+    {
+        g_hash_table_remove (group->grid_oversized, entry);
+        return;
+    }
+
+    for (cy = entry->cy1; cy <= entry->cy2; cy++)
+        for (cx = entry->cx1; cx <= entry->cx2; cx++)
+        {
+            key = group_grid_key (cx, cy);
+            cell = g_hash_table_lookup (group->grid_cells, &key);
+            g_ptr_array_remove_fast (cell->entries, entry);
+            if (cell->entries->len == 0)
+                g_hash_table_remove (group->grid_cells, &key);
+        }
+}
+
+static void
+group_grid_add (EelCanvasGroup *group, EelCanvasItem *item)
+{
+    GroupGridEntry *entry;
+
+    if (group->grid_entries == NULL)
+    {
+        group->grid_cells = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                            NULL, group_grid_cell_free);
+        group->grid_entries = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        group->grid_oversized = g_hash_table_new (NULL, NULL);
+    }
+
+    entry = g_new0 (GroupGridEntry, 1);
+    entry->item = item;
+    g_hash_table_insert (group->grid_entries, item, entry);
+    group_grid_link (group, entry);
+
+    group->grid_serials_valid = FALSE;
+}
+
+static void
+group_grid_remove (EelCanvasGroup *group, EelCanvasItem *item)
+{
+    GroupGridEntry *entry;
+
+    if (group->grid_entries == NULL)
+        return;
+
+    entry = g_hash_table_lookup (group->grid_entries, item);
+    if (entry == NULL)
+        return;
+
+    group_grid_unlink (group, entry);
+    g_hash_table_remove (group->grid_entries, item);
+
+    /* Removing an item leaves the order of the others intact */
+}
+
+/* Moves an item to the cells matching its current bounds */
+static void
+group_grid_update (EelCanvasGroup *group, EelCanvasItem *item)
+{
+    GroupGridEntry *entry;
+
+    if (group->grid_entries == NULL)
+        return;
+
+    entry = g_hash_table_lookup (group->grid_entries, item);
+    if (entry == NULL)
+        return;
+
+    if (entry->x1 == item->x1 && entry->y1 == item->y1 &&
+            entry->x2 == item->x2 && entry->y2 == item->y2)
+        return;
+
+    group_grid_unlink (group, entry);
+    group_grid_link (group, entry);
+}
+
+static void
+group_grid_ensure_serials (EelCanvasGroup *group)
+{
+    GroupGridEntry *entry;
+    GList *list;
+    guint serial;
+
+    if (group->grid_serials_valid)
+        return;
+
+    serial = 0;
+    for (list = group->item_list; list; list = list->next)
+    {
+        entry = g_hash_table_lookup (group->grid_entries, list->data);
+        entry->serial = serial++;
+    }
+
+    group->grid_serials_valid = TRUE;
+}
+
+static int
+compare_grid_entries_by_serial (gconstpointer a, gconstpointer b)
+{
+    const GroupGridEntry *entry_a, *entry_b;
+
+    entry_a = *(const GroupGridEntry **) a;
+    entry_b = *(const GroupGridEntry **) b;
+
+    if (entry_a->serial < entry_b->serial)
+        return -1;
+    if (entry_a->serial > entry_b->serial)
+        return 1;
+    return 0;
+}
+
+/* Returns the children of a group that may overlap a rectangle in canvas
+ * pixels, bottommost first. The caller still has to check the bounds of
+ * each of them and must free the array.
+ */
+static GPtrArray *
+group_get_children_in_rect (EelCanvasGroup *group,
+                            double x1, double y1, double x2, double y2)
+{
+    GPtrArray *children, *entries;
+    GroupGridCell *cell;
+    GroupGridEntry *entry;
+    GHashTableIter iter;
+    GList *list;
+    gint64 key;
+    int cx1, cy1, cx2, cy2;
+    int cx, cy;
+    guint i;
+
+    children = g_ptr_array_new ();
+
+    if (group->grid_entries == NULL
+            || g_hash_table_size (group->grid_entries) < GROUP_GRID_MIN_ITEMS
+            || !group_grid_cell_range (x1, y1, x2, y2,
+                                       GROUP_GRID_MAX_QUERY_CELLS,
+                                       &cx1, &cy1, &cx2, &cy2))
+    {
+        for (list = group->item_list; list; list = list->next)
+            g_ptr_array_add (children, list->data);
+
+        return children;
+    }
+
+    group_grid_ensure_serials (group);
+    group->grid_stamp++;
+
+    entries = g_ptr_array_new ();
+
+    for (cy = cy1; cy <= cy2; cy++)
+        for (cx = cx1; cx <= cx2; cx++)
+        {
+            key = group_grid_key (cx, cy);
+            cell = g_hash_table_lookup (group->grid_cells, &key);
+            if (cell == NULL)
+                continue;
+
+            for (i = 0; i < cell->entries->len; i++)
+            {
+                entry = g_ptr_array_index (cell->entries, i);
+                if (entry->stamp != group->grid_stamp)
+                {
+                    entry->stamp = group->grid_stamp;
+                    g_ptr_array_add (entries, entry);
+                }
+            }
+        }
+
+    g_hash_table_iter_init (&iter, group->grid_oversized);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL))
+        g_ptr_array_add (entries, entry);
+
+    g_ptr_array_sort (entries, compare_grid_entries_by_serial);
+
+    for (i = 0; i < entries->len; i++)
+    {
+        entry = g_ptr_array_index (entries, i);
+        g_ptr_array_add (children, entry->item);
+    }
+    g_ptr_array_free (entries, TRUE);
+
+    return children;
+}
+
 /* Destroy handler for canvas groups */
 static void
 eel_canvas_group_destroy (EelCanvasItem *object)
@@ -1413,6 +1736,10 @@ eel_canvas_group_destroy (EelCanvasItem *object)
         eel_canvas_item_destroy (child);
     }
 
+    g_clear_pointer (&group->grid_cells, g_hash_table_destroy);
+    g_clear_pointer (&group->grid_entries, g_hash_table_destroy);
+    g_clear_pointer (&group->grid_oversized, g_hash_table_destroy);
+
     if (EEL_CANVAS_ITEM_CLASS (group_parent_class)->destroy)
         (* EEL_CANVAS_ITEM_CLASS (group_parent_class)->destroy) (object);
 }
@@ -1544,14 +1871,22 @@ eel_canvas_group_draw (EelCanvasItem  *item,
                        cairo_region_t *region)
 {
     EelCanvasGroup *group;
-    GList *list;
+    GPtrArray *children;
+    cairo_rectangle_int_t extents;
+    guint i;
     EelCanvasItem *child = NULL;
 
     group = EEL_CANVAS_GROUP (item);
 
-    for (list = group->item_list; list; list = list->next)
+    cairo_region_get_extents (region, &extents);
+    children = group_get_children_in_rect (group,
+                                           extents.x - 1, extents.y - 1,
+                                           extents.x + extents.width,
+                                           extents.y + extents.height);
+
+    for (i = 0; i < children->len; i++)
     {
-        child = list->data;
+        child = g_ptr_array_index (children, i);
 
         if ((child->flags & EEL_CANVAS_ITEM_MAPPED) &&
                 (EEL_CANVAS_ITEM_GET_CLASS (child)->draw))
@@ -1567,6 +1902,8 @@ eel_canvas_group_draw (EelCanvasItem  *item,
                 EEL_CANVAS_ITEM_GET_CLASS (child)->draw (child, cr, region);
         }
     }
+
+    g_ptr_array_free (children, TRUE);
 }
 
 /* Point handler for canvas groups */
@@ -1579,7 +1916,8 @@ eel_canvas_group_point (EelCanvasItem *item, double x, double y, int cx, int cy,
     double dist, best;
     int has_point;
     EelCanvasGroup *group;
-    GList *list;
+    GPtrArray *children;
+    guint i;
     EelCanvasItem *point_item;
     EelCanvasItem *child = NULL;
 
@@ -1598,9 +1936,11 @@ eel_canvas_group_point (EelCanvasItem *item, double x, double y, int cx, int cy,
 
     dist = 0.0; /* keep gcc happy */
 
-    for (list = group->item_list; list; list = list->next)
+    children = group_get_children_in_rect (group, x1, y1, x2, y2);
+
+    for (i = 0; i < children->len; i++)
     {
-        child = list->data;
+        child = g_ptr_array_index (children, i);
 
         if ((child->x1 > x2) || (child->y1 > y2) || (child->x2 < x1) || (child->y2 < y1))
             continue;
@@ -1626,6 +1966,8 @@ eel_canvas_group_point (EelCanvasItem *item, double x, double y, int cx, int cy,
         }
     }
 
+    g_ptr_array_free (children, TRUE);
+
     return best;
 }
 
@@ -1735,6 +2077,8 @@ group_add (EelCanvasGroup *group, EelCanvasItem *item)
     else
         group->item_list_end = g_list_append (group->item_list_end, item)->next;
 
+    group_grid_add (group, item);
+
     if (item->flags & EEL_CANVAS_ITEM_VISIBLE &&
             group->item.flags & EEL_CANVAS_ITEM_MAPPED)
     {
@@ -1779,6 +2123,8 @@ group_remove (EelCanvasGroup *group, EelCanvasItem *item)
 
             /* Remove it from the list */
 
+            group_grid_remove (group, item);
+
             if (children == group->item_list_end)
                 group->item_list_end = children->prev;
 
@@ -2104,6 +2450,12 @@ eel_canvas_init (EelCanvas *canvas)
 static void
 remove_idle (EelCanvas *canvas)
 {
+    if (canvas->tick_id != 0)
+    {
+        gtk_widget_remove_tick_callback (GTK_WIDGET (canvas), canvas->tick_id);
+        canvas->tick_id = 0;
+    }
+
     if (canvas->idle_id == 0)
         return;
 
@@ -2124,6 +2476,7 @@ shutdown_transients (EelCanvas *canvas)
     {
         canvas->need_redraw = FALSE;
     }
+    g_clear_pointer (&canvas->damage, cairo_region_destroy);
 
     if (canvas->grabbed_item)
     {
@@ -2960,11 +3313,7 @@ eel_canvas_draw (GtkWidget *widget, cairo_t *cr)
       g_print ("Draw\n");
 #endif
     /* If there are any outstanding items that need updating, do them now */
-    if (canvas->idle_id)
-    {
-        g_source_remove (canvas->idle_id);
-        canvas->idle_id = 0;
-    }
+    remove_idle (canvas);
     if (canvas->need_update)
     {
         g_return_val_if_fail (!canvas->doing_update, FALSE);
@@ -2979,6 +3328,12 @@ eel_canvas_draw (GtkWidget *widget, cairo_t *cr)
         canvas->need_update = FALSE;
     }
 
+    /* Whatever was damaged outside of the current clip gets painted
+     * in the next frame */
+    if (canvas->damage != NULL)
+        cairo_region_subtract (canvas->damage, region);
+    flush_damage (canvas);
+
     /* Hmmm. Would like to queue antiexposes if the update marked
        anything that is gonna get redrawn as invalid */
 
@@ -3028,9 +3383,81 @@ eel_canvas_draw_background (EelCanvas *canvas,
     cairo_restore (cr);
 }
 
+/* Most rectangles a redraw is split into, see merge_damage () */
+#define MAX_DAMAGE_RECTS 16
+
+static struct
+{
+    guint passes;
+    gint64 total_time;
+    gint64 max_time;
+    guint redraw_requests;
+    guint damage_rectangles;
+} update_statistics;
+
+/* Merges a damaged area into about MAX_DAMAGE_RECTS rectangles, so that a
+ * burst of small redraws does not cut the next frame into many pieces.
+ * The rectangles of a region are sorted from top to bottom, each run of
+ * them is replaced by its extents.
+ */
+static cairo_region_t *
+merge_damage (cairo_region_t *damage)
+{
+    cairo_region_t *merged;
+    cairo_rectangle_int_t extents, rect;
+    int n_rects, run, i, j;
+
+    n_rects = cairo_region_num_rectangles (damage);
+    if (n_rects <= MAX_DAMAGE_RECTS)
+        return cairo_region_reference (damage);
+
+    merged = cairo_region_create ();
+    run = (n_rects + MAX_DAMAGE_RECTS - 1) / MAX_DAMAGE_RECTS;
+
+    for (i = 0; i < n_rects; i += run)
+    {
+        cairo_region_get_rectangle (damage, i, &extents);
+        for (j = i + 1; j < i + run && j < n_rects; j++)
+        {
+            cairo_region_get_rectangle (damage, j, &rect);
+            gdk_rectangle_union (&extents, &rect, &extents);
+        }
+        cairo_region_union_rectangle (merged, &extents);
+    }
+
+    return merged;
+}
+
+/* Invalidates the area damaged since the last update pass */
+static void
+flush_damage (EelCanvas *canvas)
+{
+    cairo_region_t *merged;
+
+    canvas->need_redraw = FALSE;
+
+    if (canvas->damage == NULL)
+        return;
+
+    if (gtk_widget_is_drawable (GTK_WIDGET (canvas)))
+    {
+        merged = merge_damage (canvas->damage);
+        update_statistics.damage_rectangles += cairo_region_num_rectangles (merged);
+        gdk_window_invalidate_region (gtk_layout_get_bin_window (GTK_LAYOUT (canvas)),
+                                      merged, FALSE);
+        cairo_region_destroy (merged);
+    }
+
+    g_clear_pointer (&canvas->damage, cairo_region_destroy);
+}
+
 static void
 do_update (EelCanvas *canvas)
 {
+    gint64 start, elapsed;
+
+    start = g_get_monotonic_time ();
+
     /* Cause the update if necessary */
 
 update_again:
@@ -3065,6 +3492,13 @@ update_again:
     {
         goto update_again;
     }
+
+    flush_damage (canvas);
+
+    elapsed = g_get_monotonic_time () - start;
+    update_statistics.passes++;
+    update_statistics.total_time += elapsed;
+    update_statistics.max_time = MAX (update_statistics.max_time, elapsed);
 }
 
 /* Idle handler for the canvas.  It deals with pending updates and redraws. */
@@ -3082,11 +3516,43 @@ idle_handler (gpointer data)
     return FALSE;
 }
 
+/* Same as the idle handler, run by the frame clock right before painting */
+static gboolean
+tick_callback (GtkWidget     *widget,
+               GdkFrameClock *frame_clock,
+               gpointer       data)
+{
+    EelCanvas *canvas;
+
+    canvas = EEL_CANVAS (widget);
+    do_update (canvas);
+
+    /* Reset tick id, redraws requested by the items while updating are
+     * flushed by this same pass */
+    canvas->tick_id = 0;
+
+    return G_SOURCE_REMOVE;
+}
+
 /* Convenience function to add an idle handler to a canvas */
 static void
 add_idle (EelCanvas *canvas)
 {
-    if (!canvas->idle_id)
+    if (canvas->idle_id || canvas->tick_id)
+        return;
+
+    /* While the canvas is on screen, all the updates and redraws
+     * requested during a frame are handled in one pass, just before
+     * that frame gets painted. The frame clock does not tick for hidden
+     * windows, so the idle handler is used for those.
+     */
+    if (gtk_widget_get_mapped (GTK_WIDGET (canvas)))
+    {
+        canvas->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (canvas),
+                          tick_callback,
+                          NULL, NULL);
+    }
+    else
     {
         /* We let the update idle handler have higher priority
          * than the redraw idle handler so the canvas state
@@ -3448,8 +3914,33 @@ eel_canvas_request_redraw (EelCanvas *canvas, int x1, int y1, int x2, int y2)
     bbox.width = x2 - x1;
     bbox.height = y2 - y1;
 
-    gdk_window_invalidate_rect (gtk_layout_get_bin_window (GTK_LAYOUT (canvas)),
-                                &bbox, FALSE);
+    /* Collected and invalidated at once by the next update pass */
+    if (canvas->damage == NULL)
+        canvas->damage = cairo_region_create ();
+    cairo_region_union_rectangle (canvas->damage, &bbox);
+    update_statistics.redraw_requests++;
+
+    canvas->need_redraw = TRUE;
+    add_idle (canvas);
+}
+
+void
+eel_canvas_get_update_statistics (guint  *passes,
+                                  gint64 *total_time,
+                                  gint64 *max_time,
+                                  guint  *redraw_requests,
+                                  guint  *damage_rectangles)
+{
+    if (passes)
+        *passes = update_statistics.passes;
+    if (total_time)
+        *total_time = update_statistics.total_time;
+    if (max_time)
+        *max_time = update_statistics.max_time;
+    if (redraw_requests)
+        *redraw_requests = update_statistics.redraw_requests;
+    if (damage_rectangles)
+        *damage_rectangles = update_statistics.damage_rectangles;
 }
 
 /**
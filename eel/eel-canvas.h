@@ -327,6 +327,13 @@ extern "C" {
         /* Children of the group */
         GList *item_list;
         GList *item_list_end;
+
+        /* Spatial index of the children, private */
+        GHashTable *grid_cells;
+        GHashTable *grid_entries;
+        GHashTable *grid_oversized;
+        guint grid_stamp;
+        guint grid_serials_valid : 1;
     };
 
     struct _EelCanvasGroupClass
@@ -378,6 +385,12 @@ extern "C" {
         /* Idle handler ID */
         guint idle_id;
 
+        /* Tick callback ID, used instead of the idle handler while mapped */
+        guint tick_id;
+
+        /* Area to repaint at the end of the next update pass */
+        cairo_region_t *damage;
+
         /* Signal handler ID for destruction of the root item */
         guint root_destroy_id;
 
@@ -486,6 +499,15 @@ extern "C" {
      */
     void eel_canvas_request_redraw (EelCanvas *canvas, int x1, int y1, int x2, int y2);
 
+    /* Timings of the update passes of all canvases, in microseconds, and
+     * the number of redraw requests and of rectangles they were merged into.
+     */
+    void eel_canvas_get_update_statistics (guint  *passes,
+                                           gint64 *total_time,
+                                           gint64 *max_time,
+                                           guint  *redraw_requests,
+                                           guint  *damage_rectangles);
+
     /* These functions convert from a coordinate system to another.  "w" is world
      * coordinates, "c" is canvas pixel coordinates (pixel coordinates that are
      * (0,0) for the upper-left scrolling limit and something else for the
@@ -55,6 +55,7 @@ struct CajaBookmarkDetails
     CajaFile *file;
 
     char *scroll_file;
+    GList *selection;
 };
 
 static void	  caja_bookmark_connect_file	  (CajaBookmark	 *file);
@@ -82,6 +83,7 @@ caja_bookmark_finalize (GObject *object)
         g_object_unref (bookmark->details->icon);
     }
     g_free (bookmark->details->scroll_file);
+    g_list_free_full (bookmark->details->selection, g_object_unref);
     g_free (bookmark->details);
 
     G_OBJECT_CLASS (caja_bookmark_parent_class)->finalize (object);
@@ -685,3 +687,19 @@ caja_bookmark_get_scroll_pos (CajaBookmark      *bookmark)
 {
     return g_strdup (bookmark->details->scroll_file);
 }
+
+/* The selection is a list of GFile, used to restore the selection when
+ * going back or forward to the location of a history item. */
+void
+caja_bookmark_set_selection (CajaBookmark      *bookmark,
+                             GList             *selection)
+{
+    g_list_free_full (bookmark->details->selection, g_object_unref);
+    bookmark->details->selection = g_list_copy_deep (selection, (GCopyFunc) g_object_ref, NULL);
+}
+
+GList *
+caja_bookmark_get_selection (CajaBookmark      *bookmark)
+{
+    return g_list_copy_deep (bookmark->details->selection, (GCopyFunc) g_object_ref, NULL);
+}
@@ -90,6 +90,9 @@ int                   caja_bookmark_compare_uris           (gconstpointer
 void                  caja_bookmark_set_scroll_pos         (CajaBookmark      *bookmark,
         const char            *uri);
 char *                caja_bookmark_get_scroll_pos         (CajaBookmark      *bookmark);
+void                  caja_bookmark_set_selection          (CajaBookmark      *bookmark,
+        GList                 *selection);
+GList *               caja_bookmark_get_selection          (CajaBookmark      *bookmark);
 
 /* Helper functions for displaying bookmarks */
 cairo_surface_t *     caja_bookmark_get_surface            (CajaBookmark      *bookmark,
@@ -221,8 +221,8 @@ update_info_from_link (CajaDesktopIconFile *icon_file)
         g_object_unref (file->details->icon);
     }
     file->details->icon = caja_desktop_link_get_icon (link);
-    g_free (file->details->activation_uri);
-    file->details->activation_uri = caja_desktop_link_get_activation_uri (link);
+    g_free (CAJA_FILE_COLD (file, activation_uri, NULL));
+    caja_file_get_cold_details (file)->activation_uri = caja_desktop_link_get_activation_uri (link);
     file->details->got_link_info = TRUE;
     file->details->link_info_is_up_to_date = TRUE;
 
@@ -34,12 +34,32 @@
 #include "caja-file-utilities.h"
 
 #include <glib/gstdio.h>
+#include <gio/gio.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
-static guint save_in_idle_source_id = 0;
+/* Milliseconds to wait for more changes before saving, dragging a
+ * group of icons changes the metadata of every icon in turn. */
+#define SAVE_DELAY 1000
+
+static guint save_timeout_id = 0;
+
+/* The keyfile is only serialized on the main thread, the worker thread
+ * gets the resulting data and writes it. Each serialization gets a
+ * generation, so that older data never replaces newer data on disk. */
+typedef struct {
+    gchar *contents;
+    gsize length;
+    guint generation;
+} SaveData;
+
+static GMutex save_mutex;
+static guint save_generation = 0;
+static guint saved_generation = 0;
+static gboolean save_in_progress = FALSE;
+static gboolean save_again = FALSE;
 
 static gchar *
 get_keyfile_path (void)
@@ -54,24 +74,30 @@ get_keyfile_path (void)
     return retval;
 }
 
-static gboolean
-save_in_idle_cb (gpointer data)
+static void
+save_data_free (SaveData *data)
 {
-    GKeyFile *keyfile = data;
-    gchar *contents, *filename;
-    gsize length;
-    GError *error = NULL;
+    g_free (data->contents);
+    g_free (data);
+}
 
-    save_in_idle_source_id = 0;
+/* Must be called with save_mutex held */
+static void
+write_keyfile_data_locked (SaveData *data)
+{
+    gchar *filename;
+    GError *error = NULL;
 
-    contents = g_key_file_to_data (keyfile, &length, NULL);
     filename = get_keyfile_path ();
 
-    if (contents != NULL) {
-        g_file_set_contents (filename,
-                     contents, length,
-                     &error);
-        g_free (contents);
+    /* g_file_set_contents writes to a temporary file and renames it,
+     * so the file on disk is never left half written. */
+    if (data->generation > saved_generation) {
+        if (g_file_set_contents (filename,
+                         data->contents, data->length,
+                         &error)) {
+            saved_generation = data->generation;
+        }
     }
 
     if (error != NULL) {
@@ -81,18 +107,112 @@ save_in_idle_cb (gpointer data)
     }
 
     g_free (filename);
+}
+
+static void
+write_keyfile_data (SaveData *data)
+{
+    g_mutex_lock (&save_mutex);
+    write_keyfile_data_locked (data);
+    g_mutex_unlock (&save_mutex);
+}
+
+static void
+save_thread (GTask *task,
+             gpointer source_object,
+             gpointer task_data,
+             GCancellable *cancellable)
+{
+    write_keyfile_data (task_data);
+}
+
+static void save_later (void);
+
+static void
+save_done (GObject *source_object,
+           GAsyncResult *res,
+           gpointer user_data)
+{
+    save_in_progress = FALSE;
+
+    if (save_again) {
+        save_again = FALSE;
+        save_later ();
+    }
+}
+
+static GKeyFile *get_keyfile (void);
+
+static SaveData *
+serialize_keyfile (void)
+{
+    SaveData *data;
+
+    data = g_new0 (SaveData, 1);
+    data->contents = g_key_file_to_data (get_keyfile (), &data->length, NULL);
+    data->generation = ++save_generation;
+
+    return data;
+}
+
+static gboolean
+save_timeout_cb (gpointer user_data)
+{
+    GTask *task;
+
+    save_timeout_id = 0;
+
+    if (save_in_progress) {
+        save_again = TRUE;
+        return FALSE;
+    }
+
+    save_in_progress = TRUE;
+
+    task = g_task_new (NULL, NULL, save_done, NULL);
+    g_task_set_task_data (task, serialize_keyfile (),
+                  (GDestroyNotify) save_data_free);
+    g_task_run_in_thread (task, save_thread);
+    g_object_unref (task);
 
     return FALSE;
 }
 
 static void
-save_in_idle (GKeyFile *keyfile)
+save_later (void)
 {
-    if (save_in_idle_source_id != 0) {
-        g_source_remove (save_in_idle_source_id);
+    if (save_timeout_id != 0) {
+        g_source_remove (save_timeout_id);
     }
 
-    save_in_idle_source_id = g_idle_add (save_in_idle_cb, keyfile);
+    save_timeout_id = g_timeout_add (SAVE_DELAY, save_timeout_cb, NULL);
+}
+
+void
+caja_desktop_metadata_flush (void)
+{
+    SaveData *data;
+    gboolean changed;
+
+    changed = save_timeout_id != 0 || save_again;
+
+    if (save_timeout_id != 0) {
+        g_source_remove (save_timeout_id);
+        save_timeout_id = 0;
+    }
+    save_again = FALSE;
+
+    /* A save handed to the worker thread may still be queued or
+     * writing. Holding the lock waits for a write in progress, and
+     * the generations tell whether the last serialized data landed.
+     * If not, it is written here, and the worker skips it later. */
+    g_mutex_lock (&save_mutex);
+    if (changed || saved_generation < save_generation) {
+        data = serialize_keyfile ();
+        write_keyfile_data_locked (data);
+        save_data_free (data);
+    }
+    g_mutex_unlock (&save_mutex);
 }
 
 static GKeyFile *
@@ -173,7 +293,7 @@ caja_desktop_set_metadata_string (CajaFile *file,
 	    }
     }
 
-    save_in_idle (keyfile);
+    save_later ();
 
     if (caja_desktop_update_metadata_from_keyfile (file, name)) {
         caja_file_changed (file);
@@ -219,7 +339,7 @@ caja_desktop_set_metadata_stringv (CajaFile *file,
                     (const gchar **) actual_stringv,
                     length);
 
-    save_in_idle (keyfile);
+    save_later ();
 
     if (caja_desktop_update_metadata_from_keyfile (file, name)) {
         caja_file_changed (file);
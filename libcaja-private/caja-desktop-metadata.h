@@ -45,4 +45,7 @@ void caja_desktop_set_metadata_stringv (CajaFile *file,
 gboolean caja_desktop_update_metadata_from_keyfile (CajaFile *file,
                                                     const gchar *name);
 
+/* Changes are saved after a delay, this saves them right away. */
+void caja_desktop_metadata_flush (void);
+
 #endif /* __CAJA_DESKTOP_METADATA_H__ */
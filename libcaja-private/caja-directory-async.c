@@ -1000,6 +1000,14 @@ dequeue_pending_idle_callback (gpointer callback_data)
                 /* File changed, notify about the change. */
                 caja_file_ref (file);
                 changed_files = g_list_prepend (changed_files, file);
+
+                /* If this load is a reload, the other attributes of
+                 * the file are stale too. Unchanged files keep theirs. */
+                if (directory->details->reload_attributes != 0)
+                {
+                    caja_file_invalidate_attributes
+                        (file, directory->details->reload_attributes & ~CAJA_FILE_ATTRIBUTE_INFO);
+                }
             }
         }
         else
@@ -1065,6 +1073,7 @@ dequeue_pending_idle_callback (gpointer callback_data)
         caja_directory_async_state_changed (directory);
 
         directory->details->directory_loaded_sent_notification = TRUE;
+        directory->details->reload_attributes = 0;
     }
 
 drain:
@@ -1874,23 +1883,44 @@ lacks_mount (CajaFile *file)
 }
 
 static gboolean
-has_problem (CajaDirectory *directory, CajaFile *file, FileCheck problem)
+has_problem (CajaDirectory *directory, CajaFile *file,
+             RequestType type, FileCheck problem)
 {
-    GList *node;
+    GList *hint, *node;
 
     if (file != NULL)
     {
         return (* problem) (file);
     }
 
-    for (node = directory->details->file_list; node != NULL; node = node->next)
+    /* Files are mostly done in list order and readiness is checked
+     * after each of them, so start where the last check stopped
+     * instead of going through all the files that are done already.
+     */
+    hint = directory->details->lacking_hint[type];
+    if (hint == NULL)
+    {
+        hint = directory->details->file_list;
+    }
+
+    for (node = hint; node != NULL; node = node->next)
+    {
+        if ((* problem) (node->data))
+        {
+            directory->details->lacking_hint[type] = node;
+            return TRUE;
+        }
+    }
+    for (node = directory->details->file_list; node != hint; node = node->next)
     {
         if ((* problem) (node->data))
         {
+            directory->details->lacking_hint[type] = node;
             return TRUE;
         }
     }
 
+    directory->details->lacking_hint[type] = NULL;
     return FALSE;
 }
 
@@ -1908,7 +1938,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_DIRECTORY_COUNT))
     {
-        if (has_problem (directory, file, lacks_directory_count))
+        if (has_problem (directory, file, REQUEST_DIRECTORY_COUNT, lacks_directory_count))
         {
             return FALSE;
         }
@@ -1916,7 +1946,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_FILE_INFO))
     {
-        if (has_problem (directory, file, lacks_info))
+        if (has_problem (directory, file, REQUEST_FILE_INFO, lacks_info))
         {
             return FALSE;
         }
@@ -1924,7 +1954,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_FILESYSTEM_INFO))
     {
-        if (has_problem (directory, file, lacks_filesystem_info))
+        if (has_problem (directory, file, REQUEST_FILESYSTEM_INFO, lacks_filesystem_info))
         {
             return FALSE;
         }
@@ -1932,7 +1962,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_TOP_LEFT_TEXT))
     {
-        if (has_problem (directory, file, lacks_top_left))
+        if (has_problem (directory, file, REQUEST_TOP_LEFT_TEXT, lacks_top_left))
         {
             return FALSE;
         }
@@ -1940,7 +1970,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_LARGE_TOP_LEFT_TEXT))
     {
-        if (has_problem (directory, file, lacks_large_top_left))
+        if (has_problem (directory, file, REQUEST_LARGE_TOP_LEFT_TEXT, lacks_large_top_left))
         {
             return FALSE;
         }
@@ -1948,7 +1978,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_DEEP_COUNT))
     {
-        if (has_problem (directory, file, lacks_deep_count))
+        if (has_problem (directory, file, REQUEST_DEEP_COUNT, lacks_deep_count))
         {
             return FALSE;
         }
@@ -1956,7 +1986,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_THUMBNAIL))
     {
-        if (has_problem (directory, file, lacks_thumbnail))
+        if (has_problem (directory, file, REQUEST_THUMBNAIL, lacks_thumbnail))
         {
             return FALSE;
         }
@@ -1964,7 +1994,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_MOUNT))
     {
-        if (has_problem (directory, file, lacks_mount))
+        if (has_problem (directory, file, REQUEST_MOUNT, lacks_mount))
         {
             return FALSE;
         }
@@ -1972,7 +2002,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_MIME_LIST))
     {
-        if (has_problem (directory, file, lacks_mime_list))
+        if (has_problem (directory, file, REQUEST_MIME_LIST, lacks_mime_list))
         {
             return FALSE;
         }
@@ -1980,7 +2010,7 @@ request_is_satisfied (CajaDirectory *directory,
 
     if (REQUEST_WANTS_TYPE (request, REQUEST_LINK_INFO))
     {
-        if (has_problem (directory, file, lacks_link_info))
+        if (has_problem (directory, file, REQUEST_LINK_INFO, lacks_link_info))
         {
             return FALSE;
         }
@@ -2411,8 +2441,23 @@ void
 caja_directory_force_reload_internal (CajaDirectory     *directory,
                                       CajaFileAttributes file_attributes)
 {
-    /* invalidate attributes that are getting reloaded for all files */
-    caja_directory_invalidate_file_attributes (directory, file_attributes);
+    if (caja_directory_is_file_list_monitored (directory))
+    {
+        /* The new load already gets the file info of every file, and
+         * dequeue_pending_idle_callback() compares it with what we
+         * have. Only the files it finds changed get the remaining
+         * attributes invalidated, the others are left alone. */
+        directory->details->reload_attributes |= file_attributes;
+
+        caja_file_invalidate_attributes_internal (directory->details->as_file,
+                file_attributes);
+    }
+    else
+    {
+        /* invalidate attributes that are getting reloaded for all files */
+        caja_directory_invalidate_file_attributes (directory, file_attributes);
+        add_all_files_to_work_queue (directory);
+    }
 
     /* Start a new directory load. */
     file_list_cancel (directory);
@@ -2421,7 +2466,6 @@ caja_directory_force_reload_internal (CajaDirectory     *directory,
     /* Start a new directory count. */
     caja_directory_invalidate_count_and_mime_list (directory);
 
-    add_all_files_to_work_queue (directory);
     caja_directory_async_state_changed (directory);
 }
 
@@ -2836,7 +2880,7 @@ deep_count_one (DeepCountState *state,
         const char *fs_id;
 
         /* Count the directory. */
-        file->details->deep_directory_count += 1;
+        caja_file_get_cold_details (file)->deep_directory_count += 1;
 
         /* Record the fact that we have to descend into this directory. */
 
@@ -2853,18 +2897,18 @@ deep_count_one (DeepCountState *state,
     else
     {
         /* Even non-regular files count as files. */
-        file->details->deep_file_count += 1;
+        caja_file_get_cold_details (file)->deep_file_count += 1;
     }
 
     /* Count the size. */
     if (!is_seen_inode && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE))
     {
-        file->details->deep_size += g_file_info_get_size (info);
+        caja_file_get_cold_details (file)->deep_size += g_file_info_get_size (info);
     }
     /* Count the disk size. */
     if (!is_seen_inode && g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE))
     {
-        file->details->deep_size_on_disk +=
+        caja_file_get_cold_details (file)->deep_size_on_disk +=
             g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_ALLOCATED_SIZE);
     }
 }
@@ -3018,7 +3062,7 @@ deep_count_callback (GObject *source_object,
 
     if (enumerator == NULL)
     {
-        file->details->deep_unreadable_count += 1;
+        caja_file_get_cold_details (file)->deep_unreadable_count += 1;
 
         deep_count_next_dir (state);
     }
@@ -3141,11 +3185,14 @@ deep_count_start (CajaDirectory *directory,
 
     /* Start counting. */
     file->details->deep_counts_status = CAJA_REQUEST_IN_PROGRESS;
-    file->details->deep_directory_count = 0;
-    file->details->deep_file_count = 0;
-    file->details->deep_unreadable_count = 0;
-    file->details->deep_size = 0;
-    file->details->deep_size_on_disk = 0;
+    if (file->details->cold != NULL)
+    {
+        file->details->cold->deep_directory_count = 0;
+        file->details->cold->deep_file_count = 0;
+        file->details->cold->deep_unreadable_count = 0;
+        file->details->cold->deep_size = 0;
+        file->details->cold->deep_size_on_disk = 0;
+    }
     directory->details->deep_count_file = file;
 
     state = g_new0 (DeepCountState, 1);
@@ -3507,21 +3554,25 @@ top_left_read_callback (GObject *source_object,
     file_details = state->file->details;
 
     file_details->top_left_text_is_up_to_date = TRUE;
-    g_free (file_details->top_left_text);
+    if (file_details->cold != NULL)
+    {
+        g_free (file_details->cold->top_left_text);
+        file_details->cold->top_left_text = NULL;
+    }
 
     if (g_file_load_partial_contents_finish (G_FILE (source_object),
             res,
             &file_contents, &file_size,
             NULL, NULL))
     {
-        file_details->top_left_text = caja_extract_top_left_text (file_contents, state->large, file_size);
+        caja_file_get_cold_details (state->file)->top_left_text =
+            caja_extract_top_left_text (file_contents, state->large, file_size);
         file_details->got_top_left_text = TRUE;
         file_details->got_large_top_left_text = (state->large != FALSE);
         g_free (file_contents);
     }
     else
     {
-        file_details->top_left_text = NULL;
         file_details->got_top_left_text = FALSE;
         file_details->got_large_top_left_text = FALSE;
     }
@@ -3609,8 +3660,11 @@ top_left_start (CajaDirectory *directory,
 
     if (!caja_file_contains_text (file))
     {
-        g_free (file->details->top_left_text);
-        file->details->top_left_text = NULL;
+        if (file->details->cold != NULL)
+        {
+            g_free (file->details->cold->top_left_text);
+            file->details->cold->top_left_text = NULL;
+        }
         file->details->got_top_left_text = FALSE;
         file->details->got_large_top_left_text = FALSE;
         file->details->top_left_text_is_up_to_date = TRUE;
@@ -3888,10 +3942,12 @@ link_info_done (CajaDirectory *directory,
     file->details->custom_icon = NULL;
     if (uri)
     {
-        g_free (file->details->activation_uri);
-        file->details->activation_uri = NULL;
+        CajaFileColdDetails *cold;
+
+        cold = caja_file_get_cold_details (file);
+        g_free (cold->activation_uri);
         file->details->got_custom_activation_uri = TRUE;
-        file->details->activation_uri = g_strdup (uri);
+        cold->activation_uri = g_strdup (uri);
     }
     if (is_trusted)
     {
@@ -5304,6 +5360,28 @@ caja_directory_remove_file_from_work_queue (CajaDirectory *directory,
                             file);
 }
 
+/* Serve a file before the others waiting in the same queue, for
+ * files that are on screen. */
+void
+caja_directory_prioritize_file (CajaDirectory *directory,
+                                CajaFile *file)
+{
+    g_return_if_fail (file->details->directory == directory);
+
+    if (caja_file_queue_move_to_head (directory->details->high_priority_queue,
+                                      file))
+    {
+        return;
+    }
+    if (caja_file_queue_move_to_head (directory->details->low_priority_queue,
+                                      file))
+    {
+        return;
+    }
+    caja_file_queue_move_to_head (directory->details->extension_queue,
+                                  file);
+}
+
 static void
 move_file_to_low_priority_queue (CajaDirectory *directory,
                                  CajaFile *file)
@@ -0,0 +1,348 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   caja-directory-prefetch.c: loading of directories the user is likely
+   to open next
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include <config.h>
+#include "caja-directory-prefetch.h"
+#include "caja-directory.h"
+#include "caja-search-directory.h"
+
+/* Number of prefetched directories loading at the same time, kept low
+ * so that the directories the user actually opens are not delayed. */
+#define PREFETCH_MAX_LOADING 2
+
+/* Number of prefetched directories kept, loaded or not */
+#define PREFETCH_MAX_DIRECTORIES 16
+
+/* Seconds a prefetched directory is kept once it is loaded */
+#define PREFETCH_LIFETIME 60
+
+/* Milliseconds the pointer has to rest on a folder to prefetch it */
+#define PREFETCH_HOVER_DELAY 400
+
+typedef struct
+{
+    CajaDirectory *directory;
+    gboolean started;
+    gboolean loaded;
+    gulong done_loading_id;
+    guint expire_id;
+} PrefetchEntry;
+
+/* Most recently requested first */
+static GList *entries = NULL;
+
+static GFile *hover_location = NULL;
+static guint hover_timeout_id = 0;
+
+static guint prefetch_hits = 0;
+static guint prefetch_misses = 0;
+static guint prefetch_count = 0;
+
+static void start_pending_entries (void);
+
+static GList *
+find_entry (CajaDirectory *directory)
+{
+    GList *node;
+
+    for (node = entries; node != NULL; node = node->next)
+    {
+        PrefetchEntry *entry = node->data;
+
+        if (entry->directory == directory)
+        {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+entry_free (PrefetchEntry *entry)
+{
+    if (entry->done_loading_id != 0)
+    {
+        g_signal_handler_disconnect (entry->directory, entry->done_loading_id);
+    }
+    if (entry->expire_id != 0)
+    {
+        g_source_remove (entry->expire_id);
+    }
+
+    /* Removing the last monitor of a directory that is still loading
+     * cancels the load. */
+    if (entry->started)
+    {
+        caja_directory_file_monitor_remove (entry->directory, entry);
+    }
+
+    caja_directory_unref (entry->directory);
+    g_free (entry);
+}
+
+static void
+remove_entry (GList *node)
+{
+    PrefetchEntry *entry;
+
+    entry = node->data;
+    entries = g_list_delete_link (entries, node);
+    entry_free (entry);
+}
+
+static gboolean
+expire_entry_callback (gpointer callback_data)
+{
+    PrefetchEntry *entry;
+    GList *node;
+
+    entry = callback_data;
+    entry->expire_id = 0;
+
+    node = g_list_find (entries, entry);
+    g_assert (node != NULL);
+    remove_entry (node);
+
+    return FALSE;
+}
+
+static void
+entry_loaded (PrefetchEntry *entry)
+{
+    if (entry->done_loading_id != 0)
+    {
+        g_signal_handler_disconnect (entry->directory, entry->done_loading_id);
+        entry->done_loading_id = 0;
+    }
+
+    entry->loaded = TRUE;
+    entry->expire_id = g_timeout_add_seconds (PREFETCH_LIFETIME,
+                                              expire_entry_callback,
+                                              entry);
+}
+
+static void
+done_loading_callback (CajaDirectory *directory,
+                       gpointer callback_data)
+{
+    entry_loaded (callback_data);
+    start_pending_entries ();
+}
+
+static void
+start_entry (PrefetchEntry *entry)
+{
+    entry->started = TRUE;
+    prefetch_count++;
+
+    /* Only the file list is wanted, the views ask for the
+     * rest of the attributes themselves. */
+    caja_directory_file_monitor_add (entry->directory,
+                                     entry,
+                                     TRUE,
+                                     0,
+                                     NULL, NULL);
+
+    if (caja_directory_are_all_files_seen (entry->directory))
+    {
+        entry_loaded (entry);
+    }
+    else
+    {
+        entry->done_loading_id =
+            g_signal_connect (entry->directory, "done_loading",
+                              G_CALLBACK (done_loading_callback), entry);
+    }
+}
+
+static void
+start_pending_entries (void)
+{
+    GList *node;
+    int loading;
+
+    loading = 0;
+    for (node = entries; node != NULL; node = node->next)
+    {
+        PrefetchEntry *entry = node->data;
+
+        if (entry->started && !entry->loaded)
+        {
+            loading++;
+        }
+    }
+
+    for (node = entries; node != NULL && loading < PREFETCH_MAX_LOADING; node = node->next)
+    {
+        PrefetchEntry *entry = node->data;
+
+        if (!entry->started)
+        {
+            start_entry (entry);
+            if (!entry->loaded)
+            {
+                loading++;
+            }
+        }
+    }
+}
+
+void
+caja_directory_prefetch_add (GFile *location)
+{
+    CajaDirectory *directory;
+    PrefetchEntry *entry;
+    GList *node;
+
+    g_return_if_fail (G_IS_FILE (location));
+
+    directory = caja_directory_get (location);
+    if (CAJA_IS_SEARCH_DIRECTORY (directory))
+    {
+        caja_directory_unref (directory);
+        return;
+    }
+
+    node = find_entry (directory);
+    if (node != NULL)
+    {
+        /* Already requested, just make it the most recent one */
+        caja_directory_unref (directory);
+        entries = g_list_remove_link (entries, node);
+        entries = g_list_concat (node, entries);
+    }
+    else
+    {
+        entry = g_new0 (PrefetchEntry, 1);
+        entry->directory = directory;
+        entries = g_list_prepend (entries, entry);
+
+        while (g_list_length (entries) > PREFETCH_MAX_DIRECTORIES)
+        {
+            remove_entry (g_list_last (entries));
+        }
+    }
+
+    start_pending_entries ();
+}
+
+void
+caja_directory_prefetch_cancel (GFile *location)
+{
+    CajaDirectory *directory;
+    GList *node;
+
+    g_return_if_fail (G_IS_FILE (location));
+
+    directory = caja_directory_get (location);
+    node = find_entry (directory);
+    caja_directory_unref (directory);
+
+    if (node != NULL)
+    {
+        remove_entry (node);
+        start_pending_entries ();
+    }
+}
+
+static gboolean
+hover_timeout_callback (gpointer callback_data)
+{
+    hover_timeout_id = 0;
+
+    caja_directory_prefetch_add (hover_location);
+    g_clear_object (&hover_location);
+
+    return FALSE;
+}
+
+void
+caja_directory_prefetch_hover (GFile *location)
+{
+    g_return_if_fail (G_IS_FILE (location));
+
+    if (hover_location != NULL && g_file_equal (hover_location, location))
+    {
+        return;
+    }
+
+    caja_directory_prefetch_hover_cancel ();
+
+    hover_location = g_object_ref (location);
+    hover_timeout_id = g_timeout_add (PREFETCH_HOVER_DELAY,
+                                      hover_timeout_callback,
+                                      NULL);
+}
+
+void
+caja_directory_prefetch_hover_cancel (void)
+{
+    if (hover_timeout_id != 0)
+    {
+        g_source_remove (hover_timeout_id);
+        hover_timeout_id = 0;
+    }
+    g_clear_object (&hover_location);
+}
+
+void
+caja_directory_prefetch_note_visit (GFile *location)
+{
+    CajaDirectory *directory;
+
+    g_return_if_fail (G_IS_FILE (location));
+
+    directory = caja_directory_get (location);
+
+    /* A directory that is being prefetched counts as a hit too, it
+     * got a head start. The entry is left to expire, so that the view
+     * can take over its monitor without reloading. */
+    if (find_entry (directory) != NULL)
+    {
+        prefetch_hits++;
+    }
+    else
+    {
+        prefetch_misses++;
+    }
+
+    caja_directory_unref (directory);
+}
+
+void
+caja_directory_prefetch_get_statistics (guint *hits,
+                                        guint *misses,
+                                        guint *prefetched)
+{
+    if (hits != NULL)
+    {
+        *hits = prefetch_hits;
+    }
+    if (misses != NULL)
+    {
+        *misses = prefetch_misses;
+    }
+    if (prefetched != NULL)
+    {
+        *prefetched = prefetch_count;
+    }
+}
@@ -0,0 +1,47 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*-
+
+   caja-directory-prefetch.h: loading of directories the user is likely
+   to open next
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public
+   License along with this program; if not, write to the
+   Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CAJA_DIRECTORY_PREFETCH_H
+#define CAJA_DIRECTORY_PREFETCH_H
+
+#include <gio/gio.h>
+
+/* Start loading the file list of a directory in the background. Only
+ * a few directories are loaded at a time and only a bounded number is
+ * kept, the least recently requested ones are dropped first.
+ */
+void caja_directory_prefetch_add            (GFile *location);
+void caja_directory_prefetch_cancel         (GFile *location);
+
+/* Prefetch a directory the pointer rests on. Only one hover is
+ * pending at a time, and it is prefetched after a short delay unless
+ * the pointer moves on before that.
+ */
+void caja_directory_prefetch_hover          (GFile *location);
+void caja_directory_prefetch_hover_cancel   (void);
+
+/* Called when a location is actually opened, counts hits and misses. */
+void caja_directory_prefetch_note_visit     (GFile *location);
+void caja_directory_prefetch_get_statistics (guint *hits,
+					     guint *misses,
+					     guint *prefetched);
+
+#endif /* CAJA_DIRECTORY_PREFETCH_H */
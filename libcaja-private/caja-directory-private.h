@@ -84,6 +84,11 @@ struct _CajaDirectoryPrivate
     GList *file_list;
     GHashTable *file_hash;
 
+    /* For each request type, the file list node where the last
+     * readiness check found a file lacking it, the next check starts
+     * there. */
+    GList *lacking_hint[REQUEST_TYPE_LAST];
+
     /* Queues of files needing some I/O done. */
     CajaFileQueue *high_priority_queue;
     CajaFileQueue *low_priority_queue;
@@ -109,6 +114,10 @@ struct _CajaDirectoryPrivate
     gboolean directory_loaded_sent_notification;
     DirectoryLoadState *directory_load_in_progress;
 
+    /* Attributes to refetch for files that the reload in progress
+     * finds changed, see caja_directory_force_reload_internal() */
+    CajaFileAttributes reload_attributes;
+
     GList *pending_file_info; /* list of MateVFSFileInfo's that are pending */
     int confirmed_file_count;
     guint dequeue_pending_idle_id;
@@ -188,6 +197,8 @@ void               caja_directory_remove_file_monitor_link        (CajaDirectory
 void               caja_directory_schedule_dequeue_pending        (CajaDirectory         *directory);
 void               caja_directory_stop_monitoring_file_list       (CajaDirectory         *directory);
 void               caja_directory_cancel                          (CajaDirectory         *directory);
+void               caja_directory_foreach_file_in_all_directories (GFunc                      func,
+        gpointer                   user_data);
 void               caja_async_destroying_file                     (CajaFile              *file);
 void               caja_directory_force_reload_internal           (CajaDirectory         *directory,
         CajaFileAttributes     file_attributes);
@@ -238,6 +249,8 @@ void               caja_directory_add_file_to_work_queue          (CajaDirectory
         CajaFile *file);
 void               caja_directory_remove_file_from_work_queue     (CajaDirectory *directory,
         CajaFile *file);
+void               caja_directory_prioritize_file                 (CajaDirectory *directory,
+        CajaFile *file);
 
 /* debugging functions */
 int                caja_directory_number_outstanding              (void);
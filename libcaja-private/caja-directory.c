@@ -54,7 +54,24 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 static GHashTable *directories;
 
+/* The same directories, in a tree following their locations, so that
+ * all directories below a location can be found without going through
+ * every directory. */
+typedef struct DirectoryIndexNode DirectoryIndexNode;
+
+struct DirectoryIndexNode
+{
+    DirectoryIndexNode *parent;
+    char *name;
+    GHashTable *children; /* name -> DirectoryIndexNode */
+    CajaDirectory *directory;
+};
+
+static DirectoryIndexNode *directory_index;
+
 static void               caja_directory_finalize         (GObject                *object);
+static void               directory_index_add                 (CajaDirectory      *directory);
+static void               directory_index_remove              (CajaDirectory      *directory);
 static CajaDirectory *caja_directory_new              (GFile                  *location);
 static char *             real_get_name_for_self_as_new_file  (CajaDirectory      *directory);
 static GList *            real_get_file_list                  (CajaDirectory      *directory);
@@ -157,6 +174,7 @@ caja_directory_finalize (GObject *object)
     directory = CAJA_DIRECTORY (object);
 
     g_hash_table_remove (directories, directory->details->location);
+    directory_index_remove (directory);
 
     caja_directory_cancel (directory);
     g_assert (directory->details->count_in_progress == NULL);
@@ -252,6 +270,35 @@ emit_change_signals_for_all_files_in_all_directories (void)
     g_list_free (dirs);
 }
 
+/* Calls func on every file known to any directory. func must not add or
+ * remove files. Used to gather statistics for the debug log. */
+void
+caja_directory_foreach_file_in_all_directories (GFunc func,
+                                                gpointer user_data)
+{
+    GHashTableIter iter;
+    CajaDirectory *directory;
+    GList *node;
+
+    if (directories == NULL)
+    {
+        return;
+    }
+
+    g_hash_table_iter_init (&iter, directories);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &directory))
+    {
+        for (node = directory->details->file_list; node != NULL; node = node->next)
+        {
+            (* func) (node->data, user_data);
+        }
+        if (directory->details->as_file != NULL)
+        {
+            (* func) (directory->details->as_file, user_data);
+        }
+    }
+}
+
 /**
  * caja_directory_get_by_uri:
  * @uri: URI of directory to get.
@@ -293,6 +340,7 @@ caja_directory_get_internal (GFile *location, gboolean create)
         g_hash_table_insert (directories,
                              directory->details->location,
                              directory);
+        directory_index_add (directory);
     }
 
     return directory;
@@ -597,6 +645,7 @@ void
 caja_directory_remove_file (CajaDirectory *directory, CajaFile *file)
 {
     GList *node;
+    int i;
 
     g_assert (CAJA_IS_DIRECTORY (directory));
     g_assert (CAJA_IS_FILE (file));
@@ -607,6 +656,14 @@ caja_directory_remove_file (CajaDirectory *directory, CajaFile *file)
     g_assert (node != NULL);
     g_assert (node->data == file);
 
+    for (i = 0; i < REQUEST_TYPE_LAST; i++)
+    {
+        if (directory->details->lacking_hint[i] == node)
+        {
+            directory->details->lacking_hint[i] = NULL;
+        }
+    }
+
     /* Remove the item from the list. */
     directory->details->file_list = g_list_remove_link
                                     (directory->details->file_list, node);
@@ -858,7 +915,7 @@ void
 caja_directory_notify_files_added (GList *files)
 {
     GHashTable *added_lists;
-    GList *p;
+    GList *p, *changed_locations;
     GHashTable *parent_directories;
     CajaFile *file;
     GFile *parent;
@@ -871,6 +928,8 @@ caja_directory_notify_files_added (GList *files)
     /* Make a list of parent directories that will need their counts updated. */
     parent_directories = g_hash_table_new (NULL, NULL);
 
+    changed_locations = NULL;
+
     for (p = files; p != NULL; p = p->next)
     {
         location = p->data;
@@ -917,10 +976,10 @@ caja_directory_notify_files_added (GList *files)
          */
         if (file && file->details->is_added)
         {
-            /* A file already exists, it was probably renamed.
-             * If it was renamed this could be ignored, but
-             * queue a change just in case */
-            caja_file_changed (file);
+            /* A file already exists, it was probably renamed or
+             * overwritten. Reload it like a changed file, since the
+             * changes queue folds later changes into the add. */
+            changed_locations = g_list_prepend (changed_locations, location);
         }
         else
         {
@@ -938,6 +997,12 @@ caja_directory_notify_files_added (GList *files)
     g_hash_table_foreach (added_lists, call_get_file_info_free_list, NULL);
     g_hash_table_destroy (added_lists);
 
+    if (changed_locations != NULL)
+    {
+        caja_directory_notify_files_changed (changed_locations);
+        g_list_free (changed_locations);
+    }
+
     /* Invalidate count for each parent directory. */
     g_hash_table_foreach (parent_directories, invalidate_count_and_unref, NULL);
     g_hash_table_destroy (parent_directories);
@@ -1035,12 +1100,23 @@ static void
 set_directory_location (CajaDirectory *directory,
                         GFile *location)
 {
+    GList *node;
+
     if (directory->details->location)
     {
         g_object_unref (directory->details->location);
     }
     directory->details->location = g_object_ref (location);
 
+    /* The cached uris of the files are relative to the old location */
+    for (node = directory->details->file_list; node != NULL; node = node->next)
+    {
+        caja_file_clear_location_cache (CAJA_FILE (node->data));
+    }
+    if (directory->details->as_file != NULL)
+    {
+        caja_file_clear_location_cache (directory->details->as_file);
+    }
 }
 
 static void
@@ -1055,61 +1131,188 @@ change_directory_location (CajaDirectory *directory,
 
     g_hash_table_remove (directories,
                          directory->details->location);
+    directory_index_remove (directory);
 
     set_directory_location (directory, new_location);
 
     g_hash_table_insert (directories,
                          directory->details->location,
                          directory);
+    directory_index_add (directory);
+}
+
+static DirectoryIndexNode *
+directory_index_node_new (DirectoryIndexNode *parent, const char *name)
+{
+    DirectoryIndexNode *node;
+
+    node = g_new0 (DirectoryIndexNode, 1);
+    node->parent = parent;
+    node->name = g_strdup (name);
+    node->children = g_hash_table_new (g_str_hash, g_str_equal);
+
+    if (parent != NULL)
+    {
+        g_hash_table_insert (parent->children, node->name, node);
+    }
+
+    return node;
+}
+
+/* Returns the path components of a location, from the location itself
+ * up to the URI of its root. */
+static GPtrArray *
+get_location_components (GFile *location)
+{
+    GPtrArray *components;
+    GFile *file, *parent;
+    char *name;
+
+    components = g_ptr_array_new_with_free_func (g_free);
+
+    file = g_object_ref (location);
+    while ((parent = g_file_get_parent (file)) != NULL)
+    {
+        name = g_file_get_basename (file);
+        if (name == NULL)
+        {
+            name = g_file_get_uri (file);
+        }
+        g_ptr_array_add (components, name);
+
+        g_object_unref (file);
+        file = parent;
+    }
+    g_ptr_array_add (components, g_file_get_uri (file));
+    g_object_unref (file);
+
+    return components;
+}
+
+static DirectoryIndexNode *
+directory_index_lookup (GFile *location, gboolean create)
+{
+    DirectoryIndexNode *node, *child;
+    GPtrArray *components;
+    const char *name;
+    guint i;
+
+    if (directory_index == NULL)
+    {
+        if (!create)
+        {
+            return NULL;
+        }
+        directory_index = directory_index_node_new (NULL, NULL);
+    }
+
+    components = get_location_components (location);
+
+    node = directory_index;
+    for (i = components->len; node != NULL && i > 0; i--)
+    {
+        name = g_ptr_array_index (components, i - 1);
+
+        child = g_hash_table_lookup (node->children, name);
+        if (child == NULL && create)
+        {
+            child = directory_index_node_new (node, name);
+        }
+        node = child;
+    }
+
+    g_ptr_array_free (components, TRUE);
+
+    return node;
 }
 
-typedef struct
+static void
+directory_index_add (CajaDirectory *directory)
 {
-    GFile *container;
-    GList *directories;
-} CollectData;
+    DirectoryIndexNode *node;
+
+    node = directory_index_lookup (directory->details->location, TRUE);
+    node->directory = directory;
+}
 
 static void
-collect_directories_by_container (gpointer key, gpointer value, gpointer callback_data)
+directory_index_remove (CajaDirectory *directory)
 {
-    CajaDirectory *directory;
-    CollectData *collect_data;
-    GFile *location;
+    DirectoryIndexNode *node, *parent;
 
-    location = (GFile *) key;
-    directory = CAJA_DIRECTORY (value);
-    collect_data = (CollectData *) callback_data;
+    node = directory_index_lookup (directory->details->location, FALSE);
+    if (node == NULL || node->directory != directory)
+    {
+        return;
+    }
+
+    node->directory = NULL;
 
-    if (g_file_has_prefix (location, collect_data->container) ||
-            g_file_equal (collect_data->container, location))
+    /* Drop the nodes that no longer lead to any directory */
+    while (node != directory_index &&
+            node->directory == NULL &&
+            g_hash_table_size (node->children) == 0)
     {
-        caja_directory_ref (directory);
-        collect_data->directories =
-            g_list_prepend (collect_data->directories,
-                            directory);
+        parent = node->parent;
+        g_hash_table_remove (parent->children, node->name);
+        g_hash_table_destroy (node->children);
+        g_free (node->name);
+        g_free (node);
+        node = parent;
+    }
+}
+
+static void
+directory_index_collect (DirectoryIndexNode *node, GList **directories_list)
+{
+    GHashTableIter iter;
+    gpointer child;
+
+    if (node->directory != NULL)
+    {
+        *directories_list = g_list_prepend (*directories_list,
+                                            caja_directory_ref (node->directory));
+    }
+
+    g_hash_table_iter_init (&iter, node->children);
+    while (g_hash_table_iter_next (&iter, NULL, &child))
+    {
+        directory_index_collect (child, directories_list);
+    }
+}
+
+/* Returns referenced directories at or below a location */
+static GList *
+get_directories_by_container (GFile *container)
+{
+    DirectoryIndexNode *node;
+    GList *result;
+
+    result = NULL;
+
+    node = directory_index_lookup (container, FALSE);
+    if (node != NULL)
+    {
+        directory_index_collect (node, &result);
     }
+
+    return result;
 }
 
 static GList *
 caja_directory_moved_internal (GFile *old_location,
                                GFile *new_location)
 {
-    CollectData collection;
-    GList *node, *affected_files;
+    GList *moved_directories, *node, *affected_files;
     char *relative_path;
     CajaDirectory *directory = NULL;
     GFile *new_directory_location = NULL;
 
-    collection.container = old_location;
-    collection.directories = NULL;
-
-    g_hash_table_foreach (directories,
-                          collect_directories_by_container,
-                          &collection);
+    moved_directories = get_directories_by_container (old_location);
 
     affected_files = NULL;
 
-    for (node = collection.directories; node != NULL; node = node->next)
+    for (node = moved_directories; node != NULL; node = node->next)
     {
         directory = CAJA_DIRECTORY (node->data);
         new_directory_location = NULL;
@@ -1150,7 +1353,7 @@ caja_directory_moved_internal (GFile *old_location,
         caja_directory_unref (directory);
     }
 
-    g_list_free (collection.directories);
+    g_list_free (moved_directories);
 
     return affected_files;
 }
@@ -1699,10 +1902,43 @@ caja_directory_number_outstanding (void)
     return directories ? g_hash_table_size (directories) : 0;
 }
 
+/* Returns whether the index has a node for uri, and which directory it
+ * holds */
+static gboolean
+self_check_index_lookup (const char *uri, CajaDirectory **directory)
+{
+    DirectoryIndexNode *node;
+    GFile *location;
+
+    location = g_file_new_for_uri (uri);
+    node = directory_index_lookup (location, FALSE);
+    g_object_unref (location);
+
+    *directory = (node != NULL) ? node->directory : NULL;
+    return node != NULL;
+}
+
+static int
+self_check_index_count_below (const char *uri)
+{
+    GFile *location;
+    GList *list;
+    int count;
+
+    location = g_file_new_for_uri (uri);
+    list = get_directories_by_container (location);
+    g_object_unref (location);
+
+    count = g_list_length (list);
+    caja_directory_list_free (list);
+
+    return count;
+}
+
 void
 caja_self_check_directory (void)
 {
-    CajaDirectory *directory;
+    CajaDirectory *directory, *deep, *found;
     CajaFile *file;
 
     directory = caja_directory_get_by_uri ("file:///etc");
@@ -1785,6 +2021,41 @@ caja_self_check_directory (void)
     caja_directory_unref (directory);
 
     EEL_CHECK_INTEGER_RESULT (g_hash_table_size (directories), 0);
+
+    /* The location index */
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc", &found), FALSE);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///"), 0);
+
+    deep = caja_directory_get_by_uri ("file:///etc/caja-self-check/deep");
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/caja-self-check/deep", &found), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (found == deep, TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/caja-self-check", &found), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (found == NULL, TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/caja-self-check/other", &found), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///usr", &found), FALSE);
+
+    directory = caja_directory_get_by_uri ("file:///etc");
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/", &found), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (found == directory, TRUE);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///"), 2);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///etc"), 2);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///etc/caja-self-check"), 1);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///etc/caja-self-check/deep"), 1);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///usr"), 0);
+
+    /* Removing a directory prunes the nodes leading only to it */
+    caja_directory_unref (deep);
+    EEL_CHECK_INTEGER_RESULT (g_hash_table_size (directories), 1);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/caja-self-check/deep", &found), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc/caja-self-check", &found), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc", &found), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (found == directory, TRUE);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///"), 1);
+
+    caja_directory_unref (directory);
+    EEL_CHECK_INTEGER_RESULT (g_hash_table_size (directories), 0);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_index_lookup ("file:///etc", &found), FALSE);
+    EEL_CHECK_INTEGER_RESULT (self_check_index_count_below ("file:///"), 0);
 }
 
 #endif /* !CAJA_OMIT_SELF_CHECK */
@@ -390,7 +390,7 @@ check_same_fs (const char *target_uri,
     }
     if (target_fs == NULL)
     {
-        target_fs = caja_get_filesystem_id_by_uri (target_uri, TRUE);
+        target_fs = caja_get_cached_filesystem_id_by_uri (target_uri, TRUE);
     }
 
     if (dropped_file != NULL && !caja_file_is_symbolic_link (dropped_file))
@@ -399,7 +399,7 @@ check_same_fs (const char *target_uri,
     }
     if (dropped_fs == NULL)
     {
-        dropped_fs = caja_get_filesystem_id_by_uri (dropped_uri, FALSE);
+        dropped_fs = caja_get_cached_filesystem_id_by_uri (dropped_uri, FALSE);
     }
 
     if (target_fs != NULL && dropped_fs != NULL)
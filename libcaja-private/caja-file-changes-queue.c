@@ -36,20 +36,31 @@ typedef enum
     CHANGE_POSITION_REMOVE
 } CajaFileChangeKind;
 
-typedef struct
+typedef struct CajaFileChange CajaFileChange;
+
+struct CajaFileChange
 {
+    CajaFileChange *next;
     CajaFileChangeKind kind;
     GFile *from;
     GFile *to;
     GdkPoint point;
     int screen;
-} CajaFileChange;
+};
 
+/* Changes are queued from file operation threads and from the main
+ * thread, but only consumed in the main thread. Producers push onto
+ * the incoming stack with a compare-and-exchange, the consumer takes
+ * the whole stack at once and moves it to the pending queue, merging
+ * redundant changes of the same file on the way.
+ */
 typedef struct
 {
-    GList *head;
-    GList *tail;
-    GMutex mutex;
+    CajaFileChange *incoming;
+
+    /* Only used by the consumer */
+    GQueue pending;
+    GHashTable *pending_by_location;
 } CajaFileChangesQueue;
 
 static CajaFileChangesQueue *
@@ -59,7 +70,9 @@ caja_file_changes_queue_new (void)
 
     result = g_new0 (CajaFileChangesQueue, 1);
 
-    g_mutex_init (&result->mutex);
+    g_queue_init (&result->pending);
+    result->pending_by_location = g_hash_table_new (g_file_hash,
+                                                    (GEqualFunc) g_file_equal);
 
     return result;
 }
@@ -81,14 +94,15 @@ static void
 caja_file_changes_queue_add_common (CajaFileChangesQueue *queue,
                                     CajaFileChange *new_item)
 {
-    /* enqueue the new queue item while locking down the list */
-    g_mutex_lock (&queue->mutex);
-
-    queue->head = g_list_prepend (queue->head, new_item);
-    if (queue->tail == NULL)
-        queue->tail = queue->head;
+    CajaFileChange *head;
 
-    g_mutex_unlock (&queue->mutex);
+    do
+    {
+        head = g_atomic_pointer_get (&queue->incoming);
+        new_item->next = head;
+    }
+    while (!g_atomic_pointer_compare_and_exchange (&queue->incoming,
+                                                   head, new_item));
 }
 
 void
@@ -142,7 +156,7 @@ caja_file_changes_queue_file_moved (GFile *from,
 
     queue = caja_file_changes_queue_get ();
 
-    new_item = g_new (CajaFileChange, 1);
+    new_item = g_new0 (CajaFileChange, 1);
     new_item->kind = CHANGE_FILE_MOVED;
     new_item->from = g_object_ref (from);
     new_item->to = g_object_ref (to);
@@ -159,7 +173,7 @@ caja_file_changes_queue_schedule_position_set (GFile *location,
 
     queue = caja_file_changes_queue_get ();
 
-    new_item = g_new (CajaFileChange, 1);
+    new_item = g_new0 (CajaFileChange, 1);
     new_item->kind = CHANGE_POSITION_SET;
     new_item->from = g_object_ref (location);
     new_item->point = point;
@@ -175,38 +189,135 @@ caja_file_changes_queue_schedule_position_remove (GFile *location)
 
     queue = caja_file_changes_queue_get ();
 
-    new_item = g_new (CajaFileChange, 1);
+    new_item = g_new0 (CajaFileChange, 1);
     new_item->kind = CHANGE_POSITION_REMOVE;
     new_item->from = g_object_ref (location);
     caja_file_changes_queue_add_common (queue, new_item);
 }
 
+static void
+caja_file_change_free (CajaFileChange *change)
+{
+    g_object_unref (change->from);
+    if (change->to != NULL)
+    {
+        g_object_unref (change->to);
+    }
+    g_free (change);
+}
+
+/* Append a change to the pending queue, dropping whatever it makes
+ * redundant:
+ *   added + changed     -> added
+ *   changed + changed   -> changed
+ *   changed + removed   -> removed
+ *   added + removed     -> removed (a no-op for files never seen)
+ * Moves and position changes are kept as they are and end any merging
+ * for the locations involved.
+ */
+static void
+caja_file_changes_queue_append_pending (CajaFileChangesQueue *queue,
+                                        CajaFileChange *change)
+{
+    GList *link;
+    CajaFileChange *previous;
+
+    switch (change->kind)
+    {
+    case CHANGE_FILE_ADDED:
+    case CHANGE_FILE_CHANGED:
+    case CHANGE_FILE_REMOVED:
+        link = g_hash_table_lookup (queue->pending_by_location, change->from);
+        previous = link != NULL ? link->data : NULL;
+
+        if (previous != NULL && change->kind == CHANGE_FILE_CHANGED)
+        {
+            /* The file gets reloaded by the pending change anyway */
+            caja_file_change_free (change);
+            return;
+        }
+
+        if (previous != NULL && change->kind == CHANGE_FILE_REMOVED)
+        {
+            g_hash_table_remove (queue->pending_by_location, previous->from);
+            g_queue_delete_link (&queue->pending, link);
+            caja_file_change_free (previous);
+        }
+
+        g_queue_push_tail (&queue->pending, change);
+        if (change->kind == CHANGE_FILE_REMOVED)
+        {
+            g_hash_table_remove (queue->pending_by_location, change->from);
+        }
+        else
+        {
+            g_hash_table_replace (queue->pending_by_location,
+                                  change->from, queue->pending.tail);
+        }
+        break;
+
+    default:
+        g_hash_table_remove (queue->pending_by_location, change->from);
+        if (change->to != NULL)
+        {
+            g_hash_table_remove (queue->pending_by_location, change->to);
+        }
+        g_queue_push_tail (&queue->pending, change);
+        break;
+    }
+}
+
+static void
+caja_file_changes_queue_take_incoming (CajaFileChangesQueue *queue)
+{
+    CajaFileChange *head, *change, *next, *ordered;
+
+    do
+    {
+        head = g_atomic_pointer_get (&queue->incoming);
+    }
+    while (head != NULL &&
+           !g_atomic_pointer_compare_and_exchange (&queue->incoming, head, NULL));
+
+    /* The stack has the newest change first */
+    ordered = NULL;
+    for (change = head; change != NULL; change = next)
+    {
+        next = change->next;
+        change->next = ordered;
+        ordered = change;
+    }
+
+    for (change = ordered; change != NULL; change = next)
+    {
+        next = change->next;
+        change->next = NULL;
+        caja_file_changes_queue_append_pending (queue, change);
+    }
+}
+
 static CajaFileChange *
 caja_file_changes_queue_get_change (CajaFileChangesQueue *queue)
 {
-    GList *new_tail;
     CajaFileChange *result;
+    GList *link;
 
     g_assert (queue != NULL);
 
-    /* dequeue the tail item while locking down the list */
-    g_mutex_lock (&queue->mutex);
+    caja_file_changes_queue_take_incoming (queue);
 
-    if (queue->tail == NULL)
+    link = queue->pending.head;
+    if (link == NULL)
     {
-        result = NULL;
+        return NULL;
     }
-    else
+
+    result = link->data;
+    if (g_hash_table_lookup (queue->pending_by_location, result->from) == link)
     {
-        new_tail = queue->tail->prev;
-        result = queue->tail->data;
-        queue->head = g_list_remove_link (queue->head,
-                                          queue->tail);
-        g_list_free_1 (queue->tail);
-        queue->tail = new_tail;
+        g_hash_table_remove (queue->pending_by_location, result->from);
     }
-
-    g_mutex_unlock (&queue->mutex);
+    g_queue_delete_link (&queue->pending, link);
 
     return result;
 }
@@ -4664,6 +4664,85 @@ copy_job_done (gpointer user_data)
 	return FALSE;
 }
 
+static void
+add_file_device (CommonJob *job,
+		 GFile *file,
+		 GHashTable *seen_ids)
+{
+	GFileInfo *info;
+	GMount *mount;
+	const char *id;
+	char *name;
+
+	info = g_file_query_info (file,
+				  G_FILE_ATTRIBUTE_ID_FILESYSTEM,
+				  G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+				  job->cancellable,
+				  NULL);
+	if (info == NULL) {
+		return;
+	}
+
+	id = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_ID_FILESYSTEM);
+	if (id != NULL && !g_hash_table_contains (seen_ids, id)) {
+		g_hash_table_add (seen_ids, g_strdup (id));
+
+		mount = g_file_find_enclosing_mount (file, job->cancellable, NULL);
+		if (mount != NULL) {
+			name = g_mount_get_name (mount);
+			g_object_unref (mount);
+		} else if (g_file_is_native (file)) {
+			name = g_strdup (_("File System"));
+		} else {
+			name = g_file_get_uri_scheme (file);
+		}
+
+		caja_progress_info_add_device (job->progress, id, name);
+		g_free (name);
+	}
+
+	g_object_unref (info);
+}
+
+/* Tell the progress info which devices the job reads from and writes
+ * to, so that the queue can run jobs on unrelated devices concurrently.
+ * This must happen before the job is started. Sources are mostly many
+ * files from the same directory, so only the first file of each parent
+ * directory is queried. */
+static void
+add_job_devices (CommonJob *job,
+		 GList *files,
+		 GFile *destination)
+{
+	GHashTable *seen_ids, *seen_parents;
+	GFile *parent;
+	GList *l;
+
+	seen_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	seen_parents = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
+					      g_object_unref, NULL);
+
+	for (l = files; l != NULL; l = l->next) {
+		parent = g_file_get_parent (l->data);
+		if (parent != NULL) {
+			if (g_hash_table_contains (seen_parents, parent)) {
+				g_object_unref (parent);
+				continue;
+			}
+			g_hash_table_add (seen_parents, parent);
+		}
+
+		add_file_device (job, l->data, seen_ids);
+	}
+	g_hash_table_destroy (seen_parents);
+
+	if (destination != NULL) {
+		add_file_device (job, destination, seen_ids);
+	}
+
+	g_hash_table_destroy (seen_ids);
+}
+
 static gboolean
 copy_job (GIOSchedulerJob *io_job,
 	  GCancellable *cancellable,
@@ -4682,6 +4761,7 @@ copy_job (GIOSchedulerJob *io_job,
 
 	dest_fs_id = NULL;
 
+	add_job_devices (common, job->files, job->destination);
 	caja_progress_info_start (job->common.progress);
 
 	scan_sources (job->files,
@@ -5228,6 +5308,7 @@ move_job (GIOSchedulerJob *io_job,
 
 	fallbacks = NULL;
 
+	add_job_devices (common, job->files, job->destination);
 	caja_progress_info_start (job->common.progress);
 
 	verify_destination (&job->common,
@@ -59,14 +59,62 @@ typedef struct
     char emblem_keywords[1];
 } CajaFileSortByEmblemCache;
 
+/* Fields that only some files ever set. They live in a block of their
+ * own that is allocated the first time one of them is set, see
+ * caja_file_get_cold_details(), so the other files don't pay for them.
+ */
+typedef struct
+{
+    char *top_left_text;
+
+    /* Info you might get from a link (.desktop, .directory or caja link) */
+    char *activation_uri;
+
+    char *trash_orig_path;
+    time_t trash_time; /* 0 is unknown */
+
+    /* We use this to cache automatic emblems and emblem keywords
+       to speed up compare_by_emblems. */
+    CajaFileSortByEmblemCache *compare_by_emblem_cache;
+
+    guint deep_directory_count;
+    guint deep_file_count;
+    guint deep_unreadable_count;
+    goffset deep_size;
+    goffset deep_size_on_disk;
+} CajaFileColdDetails;
+
+/* Formatted string attributes of a file, see
+ * caja_file_get_string_attribute_q(). Each cacheable attribute has its
+ * own slot, so a view showing all of them never evicts one. */
+#define CAJA_FILE_STRING_ATTRIBUTE_SLOTS 15
+
+typedef struct
+{
+    guint generation;
+    guint32 known; /* bit per slot, the value can be NULL */
+    char *values[CAJA_FILE_STRING_ATTRIBUTE_SLOTS];
+} CajaFileStringAttributeCache;
+
+/* Reads a cold field, without allocating the block */
+#define CAJA_FILE_COLD(file, field, default_value) \
+	((file)->details->cold != NULL ? (file)->details->cold->field : (default_value))
+
 struct _CajaFilePrivate
 {
     CajaDirectory *directory;
 
     GRefString *name;
 
+    /* Built from the location on first use and dropped whenever the
+     * name or the location of the directory changes.
+     */
+    GRefString *uri;
+    GRefString *path; /* NULL for non-native files */
+
     /* File info: */
     GFileType type;
+    guint directory_count;
 
     GRefString *display_name;
     char *display_name_collation_key;
@@ -94,19 +142,14 @@ struct _CajaFilePrivate
 
     GRefString *mime_type;
 
-    char *selinux_context;
+    /* Interned, on SELinux systems every file has one and they are
+     * mostly the same few contexts. */
+    GRefString *selinux_context;
+
     char *description;
 
     GError *get_info_error;
 
-    guint directory_count;
-
-    guint deep_directory_count;
-    guint deep_file_count;
-    guint deep_unreadable_count;
-    goffset deep_size;
-    goffset deep_size_on_disk;
-
     GIcon *icon;
 
     char *thumbnail_path;
@@ -114,19 +157,15 @@ struct _CajaFilePrivate
     time_t thumbnail_mtime;
 
     GList *mime_list; /* If this is a directory, the list of MIME types in it. */
-    char *top_left_text;
 
     /* Info you might get from a link (.desktop, .directory or caja link) */
     char *custom_icon;
-    char *activation_uri;
 
     /* used during DND, for checking whether source and destination are on
      * the same file system.
      */
     GRefString *filesystem_id;
 
-    char *trash_orig_path;
-
     /* The following is for file operations in progress. Since
      * there are normally only a few of these, we can move them to
      * a separate hash table or something if required to keep the
@@ -134,10 +173,6 @@ struct _CajaFilePrivate
      */
     GList *operations_in_progress;
 
-    /* We use this to cache automatic emblems and emblem keywords
-       to speed up compare_by_emblems. */
-    CajaFileSortByEmblemCache *compare_by_emblem_cache;
-
     /* CajaInfoProviders that need to be run for this file */
     GList *pending_info_providers;
 
@@ -145,15 +180,22 @@ struct _CajaFilePrivate
     GList *extension_emblems;
     GList *pending_extension_emblems;
 
-    /* Attributes provided by extensions */
+    /* Attributes provided by extensions, which can set them on every
+     * file, so they are not kept with the cold details. */
     GHashTable *extension_attributes;
     GHashTable *pending_extension_attributes;
 
+    /* Formatted string attributes. Dropped whenever the file
+       changes, see caja_file_get_string_attribute_q. */
+    CajaFileStringAttributeCache *string_attribute_cache;
+
     GHashTable *metadata;
 
     /* Mount for mountpoint or the references GMount for a "mountable" */
     GMount *mount;
 
+    CajaFileColdDetails *cold;
+
     /* boolean fields: bitfield to save space, since there can be
            many CajaFile objects. */
 
@@ -233,7 +275,7 @@ struct _CajaFilePrivate
     eel_boolean_bit filesystem_use_preview        : 2; /* GFilesystemPreviewType */
     eel_boolean_bit filesystem_info_is_up_to_date : 1;
 
-    time_t trash_time; /* 0 is unknown */
+    eel_boolean_bit path_is_cached                : 1;
 };
 
 typedef struct
@@ -251,6 +293,7 @@ typedef struct
 
 CajaFile *caja_file_new_from_info                  (CajaDirectory      *directory,
         GFileInfo              *info);
+CajaFileColdDetails *caja_file_get_cold_details   (CajaFile           *file);
 void          caja_file_emit_changed                   (CajaFile           *file);
 void          caja_file_mark_gone                      (CajaFile           *file);
 char *        caja_extract_top_left_text               (const char             *text,
@@ -271,12 +314,21 @@ gboolean      caja_file_update_info                    (CajaFile           *file
         GFileInfo              *info);
 gboolean      caja_file_update_name                    (CajaFile           *file,
         const char             *name);
+gboolean      caja_file_update_metadata                (CajaFile           *file,
+        const char             *key,
+        const char             *value,
+        gboolean               *known);
+gboolean      caja_file_update_metadata_list           (CajaFile           *file,
+        const char             *key,
+        char                  **value,
+        gboolean               *known);
 gboolean      caja_file_update_metadata_from_info      (CajaFile           *file,
         GFileInfo              *info);
 
 gboolean      caja_file_update_name_and_directory      (CajaFile           *file,
         const char             *name,
         CajaDirectory      *directory);
+void          caja_file_clear_location_cache           (CajaFile           *file);
 
 gboolean      caja_file_set_display_name               (CajaFile           *file,
         const char             *display_name,
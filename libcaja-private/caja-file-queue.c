@@ -114,6 +114,36 @@ caja_file_queue_remove (CajaFileQueue *queue,
     caja_file_unref (file);
 }
 
+gboolean
+caja_file_queue_move_to_head (CajaFileQueue *queue,
+                              CajaFile *file)
+{
+    GList *link;
+
+    link = g_hash_table_lookup (queue->item_to_link_map, file);
+
+    if (link == NULL)
+    {
+        /* It's not on the queue */
+        return FALSE;
+    }
+
+    if (link == queue->head)
+    {
+        return TRUE;
+    }
+
+    if (link == queue->tail)
+    {
+        queue->tail = queue->tail->prev;
+    }
+
+    queue->head = g_list_remove_link (queue->head, link);
+    queue->head = g_list_concat (link, queue->head);
+
+    return TRUE;
+}
+
 CajaFile *
 caja_file_queue_head (CajaFileQueue *queue)
 {
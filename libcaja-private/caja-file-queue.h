@@ -44,6 +44,12 @@ CajaFile *     caja_file_queue_dequeue  (CajaFileQueue *queue);
 void               caja_file_queue_remove   (CajaFileQueue *queue,
         CajaFile      *file);
 
+/* Move a file to the head of the queue in constant time. Returns
+ * FALSE if the file is not in the queue.
+ */
+gboolean           caja_file_queue_move_to_head (CajaFileQueue *queue,
+        CajaFile      *file);
+
 /* Get the file at the head of the queue without removing or unrefing it. */
 CajaFile *     caja_file_queue_head     (CajaFileQueue *queue);
 
@@ -27,7 +27,13 @@
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
 #include <gio/gio.h>
+#include <gio/gunixmounts.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
 
 #include <eel/eel-glib-extensions.h>
 #include <eel/eel-stock-dialogs.h>
@@ -1329,6 +1335,287 @@ caja_get_filesystem_id_by_uri (const char *uri, gboolean follow)
     return filesystem_id;
 }
 
+#ifdef __linux__
+
+/* Filesystems where files can have a different st_dev than the one
+ * listed for the mount, btrfs subvolumes and the layers of union mounts.
+ * GIO ids can't be predicted for them. */
+static const char * const mount_table_unreliable_types[] =
+{
+    "btrfs",
+    "overlay",
+    "aufs",
+    NULL
+};
+
+/* Mount points with the filesystem id GIO gives files on them, longest
+ * mount path first, so that the first match is the right one. The id is
+ * NULL for mounts it can't be derived for. */
+typedef struct
+{
+    char *mount_path;
+    char *filesystem_id;
+} MountTableEntry;
+
+static GList *mount_table = NULL;
+static gboolean mount_table_loaded = FALSE;
+
+static void
+mount_table_entry_free (MountTableEntry *entry)
+{
+    g_free (entry->mount_path);
+    g_free (entry->filesystem_id);
+    g_free (entry);
+}
+
+static void
+mount_table_clear (void)
+{
+    g_list_free_full (mount_table, (GDestroyNotify) mount_table_entry_free);
+    mount_table = NULL;
+    mount_table_loaded = FALSE;
+}
+
+static void
+mounts_changed_callback (GUnixMountMonitor *monitor,
+                         gpointer user_data)
+{
+    mount_table_clear ();
+}
+
+static int
+compare_mount_path_length (gconstpointer a,
+                           gconstpointer b)
+{
+    const MountTableEntry *entry_a = a;
+    const MountTableEntry *entry_b = b;
+
+    return strlen (entry_b->mount_path) - strlen (entry_a->mount_path);
+}
+
+static void
+mount_table_load (void)
+{
+    static gboolean monitor_connected = FALSE;
+    MountTableEntry *entry;
+    char *contents, *separator;
+    char **lines, **fields, **fs_fields;
+    guint major, minor;
+    int i;
+
+    if (!monitor_connected)
+    {
+        g_signal_connect (g_unix_mount_monitor_get (), "mounts-changed",
+                          G_CALLBACK (mounts_changed_callback), NULL);
+        eel_debug_call_at_shutdown (mount_table_clear);
+        monitor_connected = TRUE;
+    }
+
+    mount_table_loaded = TRUE;
+
+    if (!g_file_get_contents ("/proc/self/mountinfo", &contents, NULL, NULL))
+    {
+        return;
+    }
+
+    /* Each line starts with: mount id, parent id, major:minor, root
+     * and mount point, with spaces in the mount point escaped in octal.
+     * The filesystem type follows a lone "-" further on. Mounts are
+     * listed in the order they were made, prepend so that a later mount
+     * on the same path comes first after the stable sort.
+     */
+    lines = g_strsplit (contents, "\n", -1);
+    for (i = 0; lines[i] != NULL; i++)
+    {
+        fields = g_strsplit (lines[i], " ", 6);
+        if (g_strv_length (fields) >= 5 &&
+                sscanf (fields[2], "%u:%u", &major, &minor) == 2)
+        {
+            entry = g_new0 (MountTableEntry, 1);
+            entry->mount_path = g_strcompress (fields[4]);
+
+            separator = strstr (lines[i], " - ");
+            fs_fields = g_strsplit (separator != NULL ? separator + 3 : "", " ", 2);
+            if (fs_fields[0] != NULL &&
+                    !g_strv_contains (mount_table_unreliable_types, fs_fields[0]))
+            {
+                /* Same format as G_FILE_ATTRIBUTE_ID_FILESYSTEM for
+                 * local files */
+                entry->filesystem_id = g_strdup_printf ("l%" G_GUINT64_FORMAT,
+                                                        (guint64) makedev (major, minor));
+            }
+            g_strfreev (fs_fields);
+
+            mount_table = g_list_prepend (mount_table, entry);
+        }
+        g_strfreev (fields);
+    }
+    g_strfreev (lines);
+    g_free (contents);
+
+    mount_table = g_list_sort (mount_table, compare_mount_path_length);
+}
+
+static const char *
+mount_table_lookup (const char *path)
+{
+    MountTableEntry *entry;
+    GList *node;
+    gsize length;
+
+    if (!mount_table_loaded)
+    {
+        mount_table_load ();
+    }
+
+    for (node = mount_table; node != NULL; node = node->next)
+    {
+        entry = node->data;
+        length = strlen (entry->mount_path);
+
+        if (strncmp (path, entry->mount_path, length) == 0 &&
+                (path[length] == '/' || path[length] == '\0' ||
+                 (length > 0 && entry->mount_path[length - 1] == '/')))
+        {
+            return entry->filesystem_id;
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns the local path a cached symbolic link points to, or NULL if
+ * path is not known to be a link.
+ */
+static char *
+get_known_link_target (const char *path)
+{
+    CajaFile *file;
+    GFile *location;
+    char *target_uri, *target_path;
+
+    location = g_file_new_for_path (path);
+    file = caja_file_get_existing (location);
+    g_object_unref (location);
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    target_path = NULL;
+    if (caja_file_is_symbolic_link (file))
+    {
+        target_uri = caja_file_get_symbolic_link_target_uri (file);
+        if (target_uri != NULL)
+        {
+            target_path = g_filename_from_uri (target_uri, NULL, NULL);
+            g_free (target_uri);
+        }
+    }
+    caja_file_unref (file);
+
+    return target_path;
+}
+
+/* Resolves the symbolic links in a local path, so that it can be matched
+ * against the mount points. This has to stay quick and must not touch
+ * the filesystems, so only links whose target is already known from a
+ * cached CajaFile are followed. The last component is only followed if
+ * follow is TRUE. Returns NULL if the path can't be resolved.
+ */
+static char *
+mount_table_resolve_path (const char *path, gboolean follow)
+{
+    char *current, *prefix, *target, *joined;
+    gsize i;
+    int links;
+
+    current = g_canonicalize_filename (path, "/");
+    links = 0;
+
+    for (i = 1; current[i - 1] != '\0'; i++)
+    {
+        if (current[i] != '/' && current[i] != '\0')
+        {
+            continue;
+        }
+        if (current[i] == '\0' && !follow)
+        {
+            break;
+        }
+
+        prefix = g_strndup (current, i);
+        target = get_known_link_target (prefix);
+        g_free (prefix);
+
+        if (target == NULL)
+        {
+            continue;
+        }
+
+        /* Same limit as the kernel's for nested links */
+        if (++links > 40)
+        {
+            g_free (target);
+            g_free (current);
+            return NULL;
+        }
+
+        joined = g_build_filename (target, current + i, NULL);
+        g_free (target);
+        g_free (current);
+        current = g_canonicalize_filename (joined, "/");
+        g_free (joined);
+
+        /* Start over, the target can contain links itself */
+        i = 0;
+    }
+
+    return current;
+}
+
+#endif /* __linux__ */
+
+/* Like caja_get_filesystem_id_by_uri, but for local files the id comes
+ * from a table of mount points, without querying the file itself. Meant
+ * for decisions that have to be quick, like the drop action while
+ * dragging. Mounts the id can't be derived for still get queried.
+ */
+char *
+caja_get_cached_filesystem_id_by_uri (const char *uri, gboolean follow)
+{
+#ifdef __linux__
+    GFile *location;
+    char *path, *resolved_path;
+    const char *filesystem_id;
+
+    location = g_file_new_for_uri (uri);
+    path = g_file_get_path (location);
+    g_object_unref (location);
+
+    resolved_path = NULL;
+    if (path != NULL)
+    {
+        resolved_path = mount_table_resolve_path (path, follow);
+        g_free (path);
+    }
+
+    if (resolved_path != NULL)
+    {
+        filesystem_id = mount_table_lookup (resolved_path);
+        g_free (resolved_path);
+
+        if (filesystem_id != NULL)
+        {
+            return g_strdup (filesystem_id);
+        }
+    }
+#endif
+
+    return caja_get_filesystem_id_by_uri (uri, follow);
+}
+
 #if !defined (CAJA_OMIT_SELF_CHECK)
 
 void
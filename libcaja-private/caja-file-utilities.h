@@ -96,5 +96,6 @@ void caja_restore_files_from_trash (GList *files,
                                     GtkWindow *parent_window);
 char * caja_get_filesystem_id_by_location (GFile *location, gboolean follow);
 char * caja_get_filesystem_id_by_uri (const char *uri, gboolean follow);
+char * caja_get_cached_filesystem_id_by_uri (const char *uri, gboolean follow);
 
 #endif /* CAJA_FILE_UTILITIES_H */
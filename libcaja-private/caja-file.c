@@ -112,6 +112,12 @@ enum {
 
 static int date_format_pref;
 
+/* Bumped whenever something global changes the formatting of
+ * string attributes, which invalidates all per-file caches. */
+static guint string_attribute_cache_generation;
+static guint string_attribute_cache_hits;
+static guint string_attribute_cache_misses;
+
 static guint signals[LAST_SIGNAL] = { 0 };
 
 static GHashTable *symbolic_links;
@@ -158,6 +164,8 @@ static char *   caja_file_get_type_as_string             (CajaFile          *fil
 static gboolean update_info_and_name                         (CajaFile          *file,
 							      GFileInfo             *info);
 static const char * caja_file_peek_display_name (CajaFile *file);
+static void     invalidate_string_attribute_cache            (CajaFile          *file);
+static void     string_attribute_cache_clear                 (CajaFileStringAttributeCache *cache);
 static const char * caja_file_peek_display_name_collation_key (CajaFile *file);
 static void file_mount_unmounted (GMount *mount,  gpointer data);
 static void metadata_hash_free (GHashTable *hash);
@@ -340,6 +348,148 @@ metadata_hash_equal (GHashTable *hash1,
 	return TRUE;
 }
 
+CajaFileColdDetails *
+caja_file_get_cold_details (CajaFile *file)
+{
+	if (file->details->cold == NULL) {
+		file->details->cold = g_slice_new0 (CajaFileColdDetails);
+	}
+
+	return file->details->cold;
+}
+
+static void
+cold_details_free (CajaFileColdDetails *cold)
+{
+	if (cold == NULL) {
+		return;
+	}
+
+	g_free (cold->top_left_text);
+	g_free (cold->activation_uri);
+	g_free (cold->trash_orig_path);
+	g_free (cold->compare_by_emblem_cache);
+
+	g_slice_free (CajaFileColdDetails, cold);
+}
+
+static void
+clear_emblem_cache (CajaFile *file)
+{
+	if (file->details->cold != NULL) {
+		g_free (file->details->cold->compare_by_emblem_cache);
+		file->details->cold->compare_by_emblem_cache = NULL;
+	}
+}
+
+static gsize
+string_memory_size (const char *string)
+{
+	return string != NULL ? strlen (string) + 1 : 0;
+}
+
+/* Rough, the buckets of a hash table are not exposed */
+static gsize
+hash_table_memory_size (GHashTable *hash)
+{
+	if (hash == NULL) {
+		return 0;
+	}
+
+	return 64 + g_hash_table_size (hash) * (2 * sizeof (gpointer) + sizeof (guint));
+}
+
+/* Heap memory owned by a file. Interned strings, which are shared with
+ * other files, are not counted. */
+static gsize
+file_get_memory_size (CajaFile *file)
+{
+	CajaFilePrivate *details;
+	gsize size;
+
+	details = file->details;
+
+	size = sizeof (CajaFile) + sizeof (CajaFilePrivate);
+
+	size += string_memory_size (details->name);
+	size += string_memory_size (details->uri);
+	size += string_memory_size (details->path);
+	if (details->display_name != details->name) {
+		size += string_memory_size (details->display_name);
+	}
+	if (details->edit_name != details->name &&
+	    details->edit_name != details->display_name) {
+		size += string_memory_size (details->edit_name);
+	}
+	size += string_memory_size (details->display_name_collation_key);
+	size += string_memory_size (details->symlink_name);
+	size += string_memory_size (details->description);
+	size += string_memory_size (details->thumbnail_path);
+	size += string_memory_size (details->custom_icon);
+
+	if (details->string_attribute_cache != NULL) {
+		int i;
+
+		size += sizeof (CajaFileStringAttributeCache);
+		for (i = 0; i < CAJA_FILE_STRING_ATTRIBUTE_SLOTS; i++) {
+			size += string_memory_size (details->string_attribute_cache->values[i]);
+		}
+	}
+	size += hash_table_memory_size (details->metadata);
+	size += hash_table_memory_size (details->extension_attributes);
+	size += hash_table_memory_size (details->pending_extension_attributes);
+
+	if (details->cold != NULL) {
+		size += sizeof (CajaFileColdDetails);
+		size += string_memory_size (details->cold->top_left_text);
+		size += string_memory_size (details->cold->activation_uri);
+		size += string_memory_size (details->cold->trash_orig_path);
+	}
+
+	return size;
+}
+
+typedef struct {
+	guint file_count;
+	guint cold_count;
+	gsize total_size;
+} MemoryStatistics;
+
+static void
+add_file_memory_size (gpointer data, gpointer user_data)
+{
+	MemoryStatistics *statistics;
+
+	statistics = user_data;
+	statistics->file_count++;
+	if (CAJA_FILE (data)->details->cold != NULL) {
+		statistics->cold_count++;
+	}
+	statistics->total_size += file_get_memory_size (CAJA_FILE (data));
+}
+
+/* For the debug log, to see what the file objects cost. total_size_inline
+ * is what the same files would take with the cold details kept inline in
+ * every file, as they were before they got a block of their own. */
+void
+caja_file_get_memory_statistics (guint *file_count,
+				 gsize *total_size,
+				 gsize *total_size_inline,
+				 guint *cold_details_count_out)
+{
+	MemoryStatistics statistics = { 0, 0, 0 };
+
+	caja_directory_foreach_file_in_all_directories (add_file_memory_size,
+							&statistics);
+
+	*file_count = statistics.file_count;
+	*total_size = statistics.total_size;
+	*total_size_inline = statistics.total_size
+		- statistics.cold_count * sizeof (CajaFileColdDetails)
+		+ statistics.file_count * (sizeof (CajaFileColdDetails) - sizeof (gpointer));
+	*cold_details_count_out = statistics.cold_count;
+}
+
 static void
 clear_metadata (CajaFile *file)
 {
@@ -414,9 +564,96 @@ caja_file_update_metadata_from_info (CajaFile *file,
 	return changed;
 }
 
+/* Takes ownership of value, NULL removes the key. */
+static gboolean
+update_metadata_value (CajaFile *file,
+		       guint id,
+		       gpointer value)
+{
+	gpointer old_value;
+	gboolean equal;
+
+	if (file->details->metadata == NULL) {
+		if (value == NULL) {
+			return FALSE;
+		}
+		file->details->metadata = g_hash_table_new (NULL, NULL);
+	}
+
+	old_value = g_hash_table_lookup (file->details->metadata,
+					 GUINT_TO_POINTER (id));
+	if (old_value == NULL && value == NULL) {
+		return FALSE;
+	}
+
+	if (old_value != NULL && value != NULL) {
+		if (id & METADATA_ID_IS_LIST_MASK) {
+			equal = eel_g_strv_equal ((char **)old_value, (char **)value);
+		} else {
+			equal = strcmp ((char *)old_value, (char *)value) == 0;
+		}
+		if (equal) {
+			foreach_metadata_free (GUINT_TO_POINTER (id), value, NULL);
+			return FALSE;
+		}
+	}
+
+	if (old_value != NULL) {
+		g_hash_table_remove (file->details->metadata,
+				     GUINT_TO_POINTER (id));
+		foreach_metadata_free (GUINT_TO_POINTER (id), old_value, NULL);
+	}
+	if (value != NULL) {
+		g_hash_table_insert (file->details->metadata,
+				     GUINT_TO_POINTER (id), value);
+	}
+
+	return TRUE;
+}
+
+/* Updates the cached value of a metadata key after it has been
+ * written, so the file does not have to be queried again. Returns
+ * FALSE in *known if the key is not one that is cached.
+ */
+gboolean
+caja_file_update_metadata (CajaFile *file,
+			   const char *key,
+			   const char *value,
+			   gboolean *known)
+{
+	guint id;
+
+	id = caja_metadata_get_id (key);
+	*known = id != 0;
+	if (id == 0) {
+		return FALSE;
+	}
+
+	return update_metadata_value (file, id, g_strdup (value));
+}
+
+gboolean
+caja_file_update_metadata_list (CajaFile *file,
+				const char *key,
+				char **value,
+				gboolean *known)
+{
+	guint id;
+
+	id = caja_metadata_get_id (key);
+	*known = id != 0;
+	if (id == 0) {
+		return FALSE;
+	}
+
+	return update_metadata_value (file, id | METADATA_ID_IS_LIST_MASK,
+				      g_strdupv (value));
+}
+
 void
 caja_file_clear_info (CajaFile *file)
 {
+	invalidate_string_attribute_cache (file);
 	file->details->got_file_info = FALSE;
 	if (file->details->get_info_error) {
 		g_error_free (file->details->get_info_error);
@@ -431,9 +668,9 @@ caja_file_clear_info (CajaFile *file)
 	}
 
 	if (!file->details->got_custom_activation_uri &&
-	    file->details->activation_uri != NULL) {
-		g_free (file->details->activation_uri);
-		file->details->activation_uri = NULL;
+	    CAJA_FILE_COLD (file, activation_uri, NULL) != NULL) {
+		g_free (file->details->cold->activation_uri);
+		file->details->cold->activation_uri = NULL;
 	}
 
 	if (file->details->icon != NULL) {
@@ -478,13 +715,14 @@ caja_file_clear_info (CajaFile *file)
 	file->details->atime = 0;
 	file->details->ctime = 0;
 	file->details->btime = 0;
-	file->details->trash_time = 0;
+	if (file->details->cold != NULL) {
+		file->details->cold->trash_time = 0;
+	}
+	g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
 	g_free (file->details->symlink_name);
 	file->details->symlink_name = NULL;
 	g_clear_pointer (&file->details->mime_type, g_ref_string_release);
 	file->details->mime_type = NULL;
-	g_free (file->details->selinux_context);
-	file->details->selinux_context = NULL;
 	g_free (file->details->description);
 	file->details->description = NULL;
 	g_clear_pointer (&file->details->owner, g_ref_string_release);
@@ -796,6 +1034,7 @@ finalize (GObject *object)
 
 	caja_directory_unref (directory);
 	g_clear_pointer (&file->details->name, g_ref_string_release);
+	caja_file_clear_location_cache (file);
 	g_clear_pointer (&file->details->display_name, g_ref_string_release);
 	g_free (file->details->display_name_collation_key);
 	g_clear_pointer (&file->details->edit_name, g_ref_string_release);
@@ -808,12 +1047,17 @@ finalize (GObject *object)
 	g_clear_pointer (&file->details->owner, g_ref_string_release);
 	g_clear_pointer (&file->details->owner_real, g_ref_string_release);
 	g_clear_pointer (&file->details->group, g_ref_string_release);
-	g_free (file->details->selinux_context);
 	g_free (file->details->description);
-	g_free (file->details->top_left_text);
 	g_free (file->details->custom_icon);
-	g_free (file->details->activation_uri);
-	g_free (file->details->compare_by_emblem_cache);
+	g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
+	cold_details_free (file->details->cold);
+	g_clear_pointer (&file->details->extension_attributes, g_hash_table_destroy);
+	g_clear_pointer (&file->details->pending_extension_attributes, g_hash_table_destroy);
+
+	if (file->details->string_attribute_cache) {
+		string_attribute_cache_clear (file->details->string_attribute_cache);
+		g_slice_free (CajaFileStringAttributeCache, file->details->string_attribute_cache);
+	}
 
 	if (file->details->thumbnail) {
 		g_object_unref (file->details->thumbnail);
@@ -830,14 +1074,6 @@ finalize (GObject *object)
 	g_list_free_full (file->details->extension_emblems, g_free);
 	g_list_free_full (file->details->pending_info_providers, g_object_unref);
 
-	if (file->details->pending_extension_attributes) {
-		g_hash_table_destroy (file->details->pending_extension_attributes);
-	}
-
-	if (file->details->extension_attributes) {
-		g_hash_table_destroy (file->details->extension_attributes);
-	}
-
 	if (file->details->metadata) {
 		metadata_hash_free (file->details->metadata);
 	}
@@ -1593,20 +1829,70 @@ caja_file_get_location (CajaFile *file)
 	return g_file_get_child (dir, file->details->name);
 }
 
-/* Return the actual uri associated with the passed-in file. */
-char *
-caja_file_get_uri (CajaFile *file)
+void
+caja_file_clear_location_cache (CajaFile *file)
+{
+	g_clear_pointer (&file->details->uri, g_ref_string_release);
+	g_clear_pointer (&file->details->path, g_ref_string_release);
+	file->details->path_is_cached = FALSE;
+}
+
+/* Return the actual uri associated with the passed-in file. The
+ * string belongs to the file and is only valid until the file is
+ * renamed or moved, callers that keep it have to copy it.
+ */
+const char *
+caja_file_peek_uri (CajaFile *file)
 {
+	GFile *loc;
 	char *uri;
+
+	g_return_val_if_fail (CAJA_IS_FILE (file), NULL);
+
+	if (file->details->uri == NULL) {
+		loc = caja_file_get_location (file);
+		uri = g_file_get_uri (loc);
+		g_object_unref (loc);
+
+		file->details->uri = g_ref_string_new (uri);
+		g_free (uri);
+	}
+
+	return file->details->uri;
+}
+
+/* Same as caja_file_peek_uri, for the local path. NULL if the file
+ * has none.
+ */
+const char *
+caja_file_peek_path (CajaFile *file)
+{
 	GFile *loc;
+	char *path;
 
 	g_return_val_if_fail (CAJA_IS_FILE (file), NULL);
 
-	loc = caja_file_get_location (file);
-	uri = g_file_get_uri (loc);
-	g_object_unref (loc);
+	if (!file->details->path_is_cached) {
+		loc = caja_file_get_location (file);
+		path = g_file_get_path (loc);
+		g_object_unref (loc);
 
-	return uri;
+		if (path != NULL) {
+			file->details->path = g_ref_string_new (path);
+			g_free (path);
+		}
+		file->details->path_is_cached = TRUE;
+	}
+
+	return file->details->path;
+}
+
+char *
+caja_file_get_uri (CajaFile *file)
+{
+	g_return_val_if_fail (CAJA_IS_FILE (file), NULL);
+
+	return g_strdup (caja_file_peek_uri (file));
 }
 
 char *
@@ -2161,20 +2447,22 @@ update_info_internal (CajaFile *file,
 
 		activation_uri = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_TARGET_URI);
 		if (activation_uri == NULL) {
-			if (file->details->activation_uri) {
-				g_free (file->details->activation_uri);
-				file->details->activation_uri = NULL;
+			if (CAJA_FILE_COLD (file, activation_uri, NULL) != NULL) {
+				g_free (file->details->cold->activation_uri);
+				file->details->cold->activation_uri = NULL;
 				changed = TRUE;
 			}
 		} else {
+			CajaFileColdDetails *cold;
 			char *old_activation_uri;
 
-			old_activation_uri = file->details->activation_uri;
-			file->details->activation_uri = g_strdup (activation_uri);
+			cold = caja_file_get_cold_details (file);
+			old_activation_uri = cold->activation_uri;
+			cold->activation_uri = g_strdup (activation_uri);
 
 			if (old_activation_uri) {
 				if (strcmp (old_activation_uri,
-					    file->details->activation_uri) != 0) {
+					    cold->activation_uri) != 0) {
 					changed = TRUE;
 				}
 				g_free (old_activation_uri);
@@ -2469,8 +2757,10 @@ update_info_internal (CajaFile *file,
 	selinux_context = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_SELINUX_CONTEXT);
 	if (eel_strcmp (file->details->selinux_context, selinux_context) != 0) {
 		changed = TRUE;
-		g_free (file->details->selinux_context);
-		file->details->selinux_context = g_strdup (selinux_context);
+		g_clear_pointer (&file->details->selinux_context, g_ref_string_release);
+		if (selinux_context != NULL) {
+			file->details->selinux_context = g_ref_string_new_intern (selinux_context);
+		}
 	}
 
 	description = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_DESCRIPTION);
@@ -2506,16 +2796,16 @@ update_info_internal (CajaFile *file,
 		trash_time = g_trash_time.tv_sec;
 #endif
 	}
-	if (file->details->trash_time != trash_time) {
+	if (CAJA_FILE_COLD (file, trash_time, 0) != trash_time) {
 		changed = TRUE;
-		file->details->trash_time = trash_time;
+		caja_file_get_cold_details (file)->trash_time = trash_time;
 	}
 
 	trash_orig_path = g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_TRASH_ORIG_PATH);
-	if (eel_strcmp (file->details->trash_orig_path, trash_orig_path) != 0) {
+	if (eel_strcmp (CAJA_FILE_COLD (file, trash_orig_path, NULL), trash_orig_path) != 0) {
 		changed = TRUE;
-		g_free (file->details->trash_orig_path);
-		file->details->trash_orig_path = g_strdup (trash_orig_path);
+		g_free (caja_file_get_cold_details (file)->trash_orig_path);
+		file->details->cold->trash_orig_path = g_strdup (trash_orig_path);
 	}
 
 	changed |=
@@ -2535,6 +2825,7 @@ update_info_internal (CajaFile *file,
 				(file->details->directory, file);
 
 			g_clear_pointer (&file->details->name, g_ref_string_release);
+			caja_file_clear_location_cache (file);
 			if (eel_strcmp (file->details->display_name, name) == 0) {
 				file->details->name = g_ref_string_acquire (file->details->display_name);
 			} else {
@@ -2556,6 +2847,8 @@ update_info_internal (CajaFile *file,
 	}
 
 	if (changed) {
+		invalidate_string_attribute_cache (file);
+
 		add_to_link_hash_table (file);
 
 		update_links_if_target (file);
@@ -2621,6 +2914,7 @@ update_name_internal (CajaFile *file,
 
 	g_clear_pointer (&file->details->name, g_ref_string_release);
 	file->details->name = g_ref_string_new (name);
+	caja_file_clear_location_cache (file);
 
 	if (!file->details->got_custom_display_name) {
 		caja_file_clear_display_name (file);
@@ -2684,6 +2978,7 @@ caja_file_update_name_and_directory (CajaFile *file,
 
 	file->details->directory = caja_directory_ref (new_directory);
 	caja_directory_unref (old_directory);
+	caja_file_clear_location_cache (file);
 
 	if (name) {
 		update_name_internal (file, name, FALSE);
@@ -2799,7 +3094,7 @@ get_time (CajaFile *file,
 		time = file->details->btime;
 		break;
 	case CAJA_DATE_TYPE_TRASHED:
-		time = file->details->trash_time;
+		time = CAJA_FILE_COLD (file, trash_time, 0);
 		break;
 	default:
 		g_assert_not_reached ();
@@ -3043,7 +3338,7 @@ fill_emblem_cache_if_needed (CajaFile *file)
 	char *scanner;
 	size_t length;
 
-	if (file->details->compare_by_emblem_cache != NULL) {
+	if (CAJA_FILE_COLD (file, compare_by_emblem_cache, NULL) != NULL) {
 		/* Got a cache already. */
 		return;
 	}
@@ -3057,10 +3352,11 @@ fill_emblem_cache_if_needed (CajaFile *file)
 	}
 
 	/* Now that we know how large the cache struct needs to be, allocate it. */
-	file->details->compare_by_emblem_cache = g_malloc (sizeof(CajaFileSortByEmblemCache) + length);
+	caja_file_get_cold_details (file)->compare_by_emblem_cache =
+		g_malloc (sizeof(CajaFileSortByEmblemCache) + length);
 
 	/* Copy them into the cache. */
-	scanner = file->details->compare_by_emblem_cache->emblem_keywords;
+	scanner = file->details->cold->compare_by_emblem_cache->emblem_keywords;
 	for (node = keywords; node != NULL; node = node->next) {
 		length = strlen ((const char *) node->data) + 1;
 		memcpy (scanner, (const char *) node->data, length);
@@ -3084,8 +3380,8 @@ compare_by_emblems (CajaFile *file_1, CajaFile *file_2)
 
 	/* We ignore automatic emblems, and only sort by user-added keywords. */
 	compare_result = 0;
-	keyword_cache_1 = file_1->details->compare_by_emblem_cache->emblem_keywords;
-	keyword_cache_2 = file_2->details->compare_by_emblem_cache->emblem_keywords;
+	keyword_cache_1 = file_1->details->cold->compare_by_emblem_cache->emblem_keywords;
+	keyword_cache_2 = file_2->details->cold->compare_by_emblem_cache->emblem_keywords;
 	for (; *keyword_cache_1 != '\0' && *keyword_cache_2 != '\0';) {
 		size_t length;
 
@@ -4189,7 +4485,7 @@ caja_file_is_trusted_link (CajaFile *file)
 gboolean
 caja_file_has_activation_uri (CajaFile *file)
 {
-	return file->details->activation_uri != NULL;
+	return CAJA_FILE_COLD (file, activation_uri, NULL) != NULL;
 }
 
 /* Return the uri associated with the passed-in file, which may not be
@@ -4201,8 +4497,8 @@ caja_file_get_activation_uri (CajaFile *file)
 {
 	g_return_val_if_fail (CAJA_IS_FILE (file), NULL);
 
-	if (file->details->activation_uri != NULL) {
-		return g_strdup (file->details->activation_uri);
+	if (CAJA_FILE_COLD (file, activation_uri, NULL) != NULL) {
+		return g_strdup (file->details->cold->activation_uri);
 	}
 
 	return caja_file_get_uri (file);
@@ -4213,8 +4509,8 @@ caja_file_get_activation_location (CajaFile *file)
 {
 	g_return_val_if_fail (CAJA_IS_FILE (file), NULL);
 
-	if (file->details->activation_uri != NULL) {
-		return g_file_new_for_uri (file->details->activation_uri);
+	if (CAJA_FILE_COLD (file, activation_uri, NULL) != NULL) {
+		return g_file_new_for_uri (file->details->cold->activation_uri);
 	}
 
 	return caja_file_get_location (file);
@@ -4973,7 +5269,7 @@ caja_file_fit_modified_date_as_string (CajaFile *file,
 static char *
 caja_file_get_trash_original_file_parent_as_string (CajaFile *file)
 {
-	if (file->details->trash_orig_path != NULL) {
+	if (CAJA_FILE_COLD (file, trash_orig_path, NULL) != NULL) {
 		CajaFile *orig_file, *parent;
 		GFile *location;
 		char *filename;
@@ -6488,6 +6784,64 @@ caja_file_get_deep_directory_count_as_string (CajaFile *file)
 	return caja_file_get_deep_count_as_string_internal (file, FALSE, FALSE, TRUE, FALSE);
 }
 
+static void
+string_attribute_cache_clear (CajaFileStringAttributeCache *cache)
+{
+	int i;
+
+	for (i = 0; i < CAJA_FILE_STRING_ATTRIBUTE_SLOTS; i++) {
+		g_free (cache->values[i]);
+		cache->values[i] = NULL;
+	}
+	cache->known = 0;
+}
+
+static void
+invalidate_string_attribute_cache (CajaFile *file)
+{
+	if (file->details->string_attribute_cache != NULL) {
+		string_attribute_cache_clear (file->details->string_attribute_cache);
+	}
+}
+
+/* Attributes that are expensive to format and only change when the
+ * file info changes or when a preference changes. Counts, volume
+ * and free space information change without the file changing,
+ * so they are never cached. Returns the cache slot of the attribute,
+ * or -1 if it is not cached. */
+static int
+get_string_attribute_cache_slot (GQuark attribute_q)
+{
+	const GQuark cacheable[CAJA_FILE_STRING_ATTRIBUTE_SLOTS] = {
+		attribute_type_q,
+		attribute_size_q,
+		attribute_size_on_disk_q,
+		attribute_size_detail_q,
+		attribute_size_on_disk_detail_q,
+		attribute_date_modified_q,
+		attribute_date_changed_q,
+		attribute_date_accessed_q,
+		attribute_date_created_q,
+		attribute_date_permissions_q,
+		attribute_trashed_on_q,
+		attribute_permissions_q,
+		attribute_octal_permissions_q,
+		attribute_owner_q,
+		attribute_group_q
+	};
+	int i;
+
+	for (i = 0; i < CAJA_FILE_STRING_ATTRIBUTE_SLOTS; i++) {
+		if (cacheable[i] == attribute_q) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static char *get_string_attribute_uncached (CajaFile *file, GQuark attribute_q);
+
 /**
  * caja_file_get_string_attribute:
  *
@@ -6509,6 +6863,78 @@ caja_file_get_deep_directory_count_as_string (CajaFile *file)
  **/
 char *
 caja_file_get_string_attribute_q (CajaFile *file, GQuark attribute_q)
+{
+	CajaFileStringAttributeCache *cache;
+	char *result;
+	int slot;
+
+	slot = get_string_attribute_cache_slot (attribute_q);
+	if (slot < 0) {
+		return get_string_attribute_uncached (file, attribute_q);
+	}
+
+	cache = file->details->string_attribute_cache;
+	if (cache == NULL) {
+		cache = g_slice_new0 (CajaFileStringAttributeCache);
+		cache->generation = string_attribute_cache_generation;
+		file->details->string_attribute_cache = cache;
+	} else if (cache->generation != string_attribute_cache_generation) {
+		string_attribute_cache_clear (cache);
+		cache->generation = string_attribute_cache_generation;
+	}
+
+	/* NULL values are cached too, they mean "unknown" */
+	if (cache->known & (1u << slot)) {
+		string_attribute_cache_hits++;
+		return g_strdup (cache->values[slot]);
+	}
+
+	string_attribute_cache_misses++;
+	result = get_string_attribute_uncached (file, attribute_q);
+
+	cache->values[slot] = g_strdup (result);
+	cache->known |= 1u << slot;
+
+	return result;
+}
+
+/**
+ * caja_file_get_string_attribute_cache_stats:
+ *
+ * Get the number of string attribute lookups that were served from
+ * the per-file cache and the number that had to be formatted.
+ * Either pointer may be NULL.
+ **/
+void
+caja_file_get_string_attribute_cache_stats (guint *hits, guint *misses)
+{
+	if (hits != NULL) {
+		*hits = string_attribute_cache_hits;
+	}
+	if (misses != NULL) {
+		*misses = string_attribute_cache_misses;
+	}
+}
+
+static void
+string_attribute_preferences_changed_callback (GSettings *settings,
+					       const char *key,
+					       gpointer user_data)
+{
+	/* Date format, size units, item counts, ... */
+	string_attribute_cache_generation++;
+}
+
+static void
+string_attribute_day_changed_callback (GObject *signaller,
+				       gpointer user_data)
+{
+	/* Informal dates ("Yesterday", ...) */
+	string_attribute_cache_generation++;
+}
+
+static char *
+get_string_attribute_uncached (CajaFile *file, GQuark attribute_q)
 {
 	char *extension_attribute;
 
@@ -7079,8 +7505,7 @@ caja_file_set_keywords (CajaFile *file, GList *keywords)
 	GList *canonical_keywords;
 
 	/* Invalidate the emblem compare cache */
-	g_free (file->details->compare_by_emblem_cache);
-	file->details->compare_by_emblem_cache = NULL;
+	clear_emblem_cache (file);
 
 	g_return_if_fail (CAJA_IS_FILE (file));
 
@@ -7515,6 +7940,7 @@ caja_file_is_binary (CajaFile *file)
 
 	gboolean is_binary = FALSE;
 	int i = 0;
+	const char *path;
 	FILE *fp;
 
 	/* Check the first 4096 bytes of the files. If these contains a 0,
@@ -7522,7 +7948,12 @@ caja_file_is_binary (CajaFile *file)
 	 * This idea is taken from python code of meld.
 	 */
 
-	fp = g_fopen (g_file_get_path (caja_file_get_location (file)), "r");
+	path = caja_file_peek_path (file);
+	if (path == NULL) {
+		return FALSE;
+	}
+
+	fp = g_fopen (path, "r");
 	if (fp == NULL)
 	{
 		return FALSE;
@@ -7611,7 +8042,7 @@ caja_file_peek_top_left_text (CajaFile *file,
 	}
 
 	/* Show what we read in. */
-	return file->details->top_left_text;
+	return CAJA_FILE_COLD (file, top_left_text, NULL);
 }
 
 /**
@@ -7642,10 +8073,10 @@ caja_file_get_trash_original_file (CajaFile *file)
 
 	original_file = NULL;
 
-	if (file->details->trash_orig_path != NULL) {
+	if (CAJA_FILE_COLD (file, trash_orig_path, NULL) != NULL) {
 		GFile *location;
 
-		location = g_file_new_for_path (file->details->trash_orig_path);
+		location = g_file_new_for_path (file->details->cold->trash_orig_path);
 		original_file = caja_file_get (location);
 		g_object_unref (location);
 	}
@@ -7753,8 +8184,9 @@ caja_file_emit_changed (CajaFile *file)
 	 * place to do it but it is the one guaranteed bottleneck through
 	 * which all change notifications pass.
 	 */
-	g_free (file->details->compare_by_emblem_cache);
-	file->details->compare_by_emblem_cache = NULL;
+	clear_emblem_cache (file);
+
+	invalidate_string_attribute_cache (file);
 
 	/* Send out a signal. */
 	g_signal_emit (file, signals[CHANGED], 0, file);
@@ -8077,8 +8509,8 @@ caja_file_invalidate_all_attributes (CajaFile *file)
 void
 caja_file_dump (CajaFile *file)
 {
-	long size = file->details->deep_size;
-	long size_on_disk = file->details->deep_size_on_disk;
+	long size = CAJA_FILE_COLD (file, deep_size, 0);
+	long size_on_disk = CAJA_FILE_COLD (file, deep_size_on_disk, 0);
 	char *uri;
 	const char *file_kind;
 
@@ -8392,6 +8824,22 @@ caja_file_list_cancel_call_when_ready (CajaFileListHandle *handle)
 	}
 }
 
+void
+caja_file_list_prioritize (GList *file_list)
+{
+	GList *l;
+	CajaFile *file;
+
+	/* Go backwards, so that the first file ends up in front */
+	for (l = g_list_last (file_list); l != NULL; l = l->prev) {
+		file = CAJA_FILE (l->data);
+
+		if (file->details->directory != NULL) {
+			caja_directory_prioritize_file (file->details->directory, file);
+		}
+	}
+}
+
 static char *
 try_to_make_utf8 (const char *text, int *length)
 {
@@ -8647,6 +9095,15 @@ caja_file_class_init (CajaFileClass *class)
 				                  CAJA_PREFERENCES_DATE_FORMAT,
 				                  &date_format_pref);
 
+	g_signal_connect (caja_preferences,
+			  "changed",
+			  G_CALLBACK (string_attribute_preferences_changed_callback),
+			  NULL);
+	g_signal_connect (caja_signaller_get_current (),
+			  "day_changed",
+			  G_CALLBACK (string_attribute_day_changed_callback),
+			  NULL);
+
 	thumbnail_limit_changed_callback (NULL);
 	g_signal_connect_swapped (caja_preferences,
 							  "changed::" CAJA_PREFERENCES_IMAGE_FILE_THUMBNAIL_LIMIT,
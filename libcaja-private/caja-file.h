@@ -179,6 +179,8 @@ char *                  caja_file_get_name                          (CajaFile
 GFile *                 caja_file_get_location                      (CajaFile                   *file);
 char *			 caja_file_get_description			 (CajaFile			 *file);
 char *                  caja_file_get_uri                           (CajaFile                   *file);
+const char *            caja_file_peek_uri                          (CajaFile                   *file);
+const char *            caja_file_peek_path                         (CajaFile                   *file);
 char *                  caja_file_get_uri_scheme                    (CajaFile                   *file);
 CajaFile *          caja_file_get_parent                        (CajaFile                   *file);
 GFile *                 caja_file_get_parent_location               (CajaFile                   *file);
@@ -392,6 +394,12 @@ char *                  caja_file_get_string_attribute_with_default (CajaFile
         const char                     *attribute_name);
 char *                  caja_file_get_string_attribute_with_default_q (CajaFile                  *file,
         GQuark                          attribute_q);
+void                    caja_file_get_string_attribute_cache_stats  (guint                          *hits,
+        guint                          *misses);
+void                    caja_file_get_memory_statistics             (guint                          *file_count,
+        gsize                          *total_size,
+        gsize                          *total_size_inline,
+        guint                          *cold_details_count);
 char *			caja_file_fit_modified_date_as_string	(CajaFile 			*file,
         int				 width,
         CajaWidthMeasureCallback    measure_callback,
@@ -490,6 +498,10 @@ void                    caja_file_list_call_when_ready              (GList
         CajaFileListCallback        callback,
         gpointer                        callback_data);
 void                    caja_file_list_cancel_call_when_ready       (CajaFileListHandle         *handle);
+/* Fetch the attributes of these files, typically the ones on screen,
+ * before those of other files in their directories. Files earlier in
+ * the list come first. */
+void                    caja_file_list_prioritize                   (GList                          *file_list);
 
 /* Debugging */
 void                    caja_file_dump                              (CajaFile                   *file);
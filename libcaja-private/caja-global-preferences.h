@@ -62,6 +62,9 @@ G_BEGIN_DECLS
 #define CAJA_PREFERENCES_DESKTOP_IS_HOME_DIR		"desktop-is-home-dir"
 #define CAJA_PREFERENCES_SHOW_NOTIFICATIONS             "show-notifications"
 
+/* File operations */
+#define CAJA_PREFERENCES_FILE_OPERATIONS_PER_DEVICE     "file-operations-per-device"
+
 /* Display  */
 #define CAJA_PREFERENCES_SHOW_HIDDEN_FILES  		"show-hidden-files"
 #define CAJA_PREFERENCES_SHOW_BACKUP_FILES  		"show-backup-files"
@@ -203,6 +206,7 @@ typedef enum
 #define CAJA_PREFERENCES_DESKTOP_VOLUMES_VISIBLE       "volumes-visible"
 #define CAJA_PREFERENCES_DESKTOP_NETWORK_VISIBLE       "network-icon-visible"
 #define CAJA_PREFERENCES_DESKTOP_NETWORK_NAME          "network-icon-name"
+#define CAJA_PREFERENCES_DESKTOP_POLL_FOR_CHANGES      "poll-for-changes"
 #define CAJA_PREFERENCES_LOCKDOWN_COMMAND_LINE         "disable-command-line"
 #define CAJA_PREFERENCES_DISABLED_EXTENSIONS           "disabled-extensions"
 
@@ -195,6 +195,36 @@ typedef struct
 
 static int click_policy_auto_value;
 
+/* Label measurements are shared by all icons, so that labels measured
+ * before, at another zoom level or in another view, and labels that
+ * are the same for many icons, like the additional text, don't need a
+ * new layout. The key has everything the measurement depends on.
+ * The least recently used measurements are dropped once there are more
+ * than two per existing icon, so that a relayout of a big folder still
+ * finds all of its labels.
+ */
+#define LABEL_METRICS_CACHE_MIN_SIZE 1024
+
+typedef struct
+{
+    int width;
+    int height;
+    int dx;
+    int height_for_entire_text;
+    int height_for_layout;
+} LabelMetrics;
+
+typedef struct
+{
+    char *key;
+    LabelMetrics metrics;
+    GList link; /* in label_metrics_lru, most recently used first */
+} LabelMetricsEntry;
+
+static GHashTable *label_metrics_cache = NULL;
+static GQueue label_metrics_lru = G_QUEUE_INIT;
+static guint icon_item_count = 0;
+
 static void caja_icon_canvas_item_text_interface_init (EelAccessibleTextIface *iface);
 static GType caja_icon_canvas_item_accessible_factory_get_type (void);
 
@@ -226,6 +256,8 @@ static void     draw_pixbuf                          (GdkPixbuf
 static PangoLayout *get_label_layout                 (PangoLayout               **layout,
     						      CajaIconCanvasItem        *item,
     						      const char                *text);
+static PangoFontDescription *get_label_font_description (CajaIconCanvasItem     *item,
+    						      PangoContext              *context);
 
 static gboolean hit_test_stretch_handle              (CajaIconCanvasItem        *item,
     						      EelIRect                  canvas_rect,
@@ -254,6 +286,8 @@ caja_icon_canvas_item_init (CajaIconCanvasItem *icon_item)
 
     icon_item->details = caja_icon_canvas_item_get_instance_private (icon_item);
     caja_icon_canvas_item_invalidate_label_size (icon_item);
+
+    icon_item_count++;
 }
 
 static void
@@ -265,6 +299,8 @@ caja_icon_canvas_item_finalize (GObject *object)
 
     details = CAJA_ICON_CANVAS_ITEM (object)->details;
 
+    icon_item_count--;
+
     if (details->cursor_window != NULL)
     {
         gdk_window_set_cursor (details->cursor_window, NULL);
@@ -1026,51 +1062,39 @@ layout_get_size_for_layout (PangoLayout *layout,
 #define TEXT_BACK_PADDING_X 4
 #define TEXT_BACK_PADDING_Y 1
 
-static void
-prepare_pango_layout_width (CajaIconCanvasItem *item,
-                            PangoLayout *layout)
+static int
+get_pango_layout_width (CajaIconCanvasItem *item)
 {
     if (caja_icon_canvas_item_get_max_text_width (item) < 0)
     {
-        pango_layout_set_width (layout, -1);
-    }
-    else
-    {
-        pango_layout_set_width (layout, floor (caja_icon_canvas_item_get_max_text_width (item)) * PANGO_SCALE);
-        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+        return -1;
     }
+
+    return floor (caja_icon_canvas_item_get_max_text_width (item)) * PANGO_SCALE;
 }
 
-static void
-prepare_pango_layout_for_measure_entire_text (CajaIconCanvasItem *item,
-        PangoLayout *layout)
+static int
+get_pango_layout_height_for_measure_entire_text (CajaIconCanvasItem *item)
 {
     CajaIconContainer *container;
 
-    prepare_pango_layout_width (item, layout);
-
     container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
 
     if (IS_COMPACT_VIEW (container))
     {
-        pango_layout_set_height (layout, -1);
-    }
-    else
-    {
-        pango_layout_set_height (layout, G_MININT);
+        return -1;
     }
+
+    return G_MININT;
 }
 
-static void
-prepare_pango_layout_for_draw (CajaIconCanvasItem *item,
-                               PangoLayout *layout)
+static int
+get_pango_layout_height_for_draw (CajaIconCanvasItem *item)
 {
     CajaIconCanvasItemPrivate *details;
     CajaIconContainer *container;
     gboolean needs_highlight;
 
-    prepare_pango_layout_width (item, layout);
-
     container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
     details = item->details;
 
@@ -1078,7 +1102,7 @@ prepare_pango_layout_for_draw (CajaIconCanvasItem *item,
 
     if (IS_COMPACT_VIEW (container))
     {
-        pango_layout_set_height (layout, -1);
+        return -1;
     }
     else if (needs_highlight ||
              details->is_highlighted_as_keyboard_focus ||
@@ -1086,7 +1110,7 @@ prepare_pango_layout_for_draw (CajaIconCanvasItem *item,
              container->details->label_position == CAJA_ICON_LABEL_POSITION_BESIDE)
     {
         /* VOODOO-TODO, cf. compute_text_rectangle() */
-        pango_layout_set_height (layout, G_MININT);
+        return G_MININT;
     }
     else
     {
@@ -1094,20 +1118,181 @@ prepare_pango_layout_for_draw (CajaIconCanvasItem *item,
          * the layout height already fits into max. layout lines. But pango should figure this
          * out itself (which it doesn't ATM).
          */
-        pango_layout_set_height (layout,
-                                 caja_icon_container_get_max_layout_lines_for_pango (container));
+        return caja_icon_container_get_max_layout_lines_for_pango (container);
+    }
+}
+
+static void
+prepare_pango_layout_width (CajaIconCanvasItem *item,
+                            PangoLayout *layout)
+{
+    int width;
+
+    width = get_pango_layout_width (item);
+    pango_layout_set_width (layout, width);
+    if (width >= 0)
+    {
+        pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_END);
+    }
+}
+
+static void
+prepare_pango_layout_for_measure_entire_text (CajaIconCanvasItem *item,
+        PangoLayout *layout)
+{
+    prepare_pango_layout_width (item, layout);
+    pango_layout_set_height (layout,
+                             get_pango_layout_height_for_measure_entire_text (item));
+}
+
+static void
+prepare_pango_layout_for_draw (CajaIconCanvasItem *item,
+                               PangoLayout *layout)
+{
+    prepare_pango_layout_width (item, layout);
+    pango_layout_set_height (layout,
+                             get_pango_layout_height_for_draw (item));
+}
+
+static void
+label_metrics_entry_free (LabelMetricsEntry *entry)
+{
+    g_free (entry->key);
+    g_free (entry);
+}
+
+static void
+label_metrics_cache_trim (void)
+{
+    LabelMetricsEntry *entry;
+    guint max_size;
+
+    max_size = MAX (LABEL_METRICS_CACHE_MIN_SIZE, 2 * icon_item_count);
+
+    while (g_hash_table_size (label_metrics_cache) > max_size)
+    {
+        entry = g_queue_peek_tail (&label_metrics_lru);
+        g_queue_unlink (&label_metrics_lru, &entry->link);
+        g_hash_table_remove (label_metrics_cache, entry->key);
+    }
+}
+
+static char *
+get_label_metrics_key (CajaIconCanvasItem *item,
+                       const char *text,
+                       gboolean editable)
+{
+    CajaIconContainer *container;
+    PangoContext *context;
+    PangoFontDescription *desc;
+    const cairo_font_options_t *font_options;
+    char *font, *key;
+
+    container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
+    context = gtk_widget_get_pango_context (GTK_WIDGET (container));
+
+    desc = get_label_font_description (item, context);
+    font = pango_font_description_to_string (desc);
+    pango_font_description_free (desc);
+
+    /* Hinting and antialiasing change the measurements too */
+    font_options = pango_cairo_context_get_font_options (context);
+
+    key = g_strdup_printf ("%s\n%g\n%lu\n%d\n%d\n%d\n%d\n%d\n%d\n%s",
+                           font,
+                           pango_cairo_context_get_resolution (context),
+                           font_options != NULL ? cairo_font_options_hash (font_options) : 0,
+                           get_pango_layout_width (item),
+                           editable ? get_pango_layout_height_for_measure_entire_text (item) : 0,
+                           get_pango_layout_height_for_draw (item),
+                           editable ? caja_icon_container_get_max_layout_lines (container) : 0,
+                           container->details->label_position,
+                           caja_icon_container_is_layout_rtl (container),
+                           text);
+    g_free (font);
+
+    return key;
+}
+
+static void
+measure_label_layout (CajaIconCanvasItem *item,
+                      PangoLayout **layout_cache,
+                      const char *text,
+                      gboolean editable,
+                      LabelMetrics *metrics)
+{
+    CajaIconContainer *container;
+    PangoLayout *layout;
+    LabelMetricsEntry *entry;
+    char *key;
+
+    if (label_metrics_cache == NULL)
+    {
+        label_metrics_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     NULL,
+                                                     (GDestroyNotify) label_metrics_entry_free);
+    }
+
+    key = get_label_metrics_key (item, text, editable);
+
+    entry = g_hash_table_lookup (label_metrics_cache, key);
+    if (entry != NULL)
+    {
+        g_queue_unlink (&label_metrics_lru, &entry->link);
+        g_queue_push_head_link (&label_metrics_lru, &entry->link);
+        *metrics = entry->metrics;
+        g_free (key);
+        return;
+    }
+
+    container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
+    layout = get_label_layout (layout_cache, item, text);
+
+    metrics->height_for_entire_text = 0;
+    metrics->height_for_layout = 0;
+
+    if (editable)
+    {
+        /* first, measure required text height: height_for_entire_text
+         * then, measure text height applicable for layout: height_for_layout
+         * next, measure actually displayed height: height
+         */
+        prepare_pango_layout_for_measure_entire_text (item, layout);
+        layout_get_full_size (layout,
+                              NULL,
+                              &metrics->height_for_entire_text,
+                              NULL);
+        layout_get_size_for_layout (layout,
+                                    caja_icon_container_get_max_layout_lines (container),
+                                    metrics->height_for_entire_text,
+                                    &metrics->height_for_layout);
     }
+
+    prepare_pango_layout_for_draw (item, layout);
+    layout_get_full_size (layout,
+                          &metrics->width,
+                          &metrics->height,
+                          &metrics->dx);
+
+    g_object_unref (layout);
+
+    entry = g_new0 (LabelMetricsEntry, 1);
+    entry->key = key;
+    entry->metrics = *metrics;
+    entry->link.data = entry;
+    g_hash_table_insert (label_metrics_cache, key, entry);
+    g_queue_push_head_link (&label_metrics_lru, &entry->link);
+
+    label_metrics_cache_trim ();
 }
 
 static void
 measure_label_text (CajaIconCanvasItem *item)
 {
     CajaIconCanvasItemPrivate *details;
-    CajaIconContainer *container;
+    LabelMetrics metrics;
     gint editable_height, editable_height_for_layout, editable_height_for_entire_text, editable_width, editable_dx;
     gint additional_height, additional_width, additional_dx;
-    PangoLayout *editable_layout;
-    PangoLayout *additional_layout;
     gboolean have_editable, have_additional;
 
     /* check to see if the cached values are still valid; if so, there's
@@ -1152,41 +1337,24 @@ measure_label_text (CajaIconCanvasItem *item)
     additional_height = 0;
     additional_dx = 0;
 
-    container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
-    editable_layout = NULL;
-    additional_layout = NULL;
-
     if (have_editable)
     {
-        /* first, measure required text height: editable_height_for_entire_text
-         * then, measure text height applicable for layout: editable_height_for_layout
-         * next, measure actually displayed height: editable_height
-         */
-        editable_layout = get_label_layout (&details->editable_text_layout, item, details->editable_text);
-
-        prepare_pango_layout_for_measure_entire_text (item, editable_layout);
-        layout_get_full_size (editable_layout,
-                              NULL,
-                              &editable_height_for_entire_text,
-                              NULL);
-        layout_get_size_for_layout (editable_layout,
-                                    caja_icon_container_get_max_layout_lines (container),
-                                    editable_height_for_entire_text,
-                                    &editable_height_for_layout);
-
-        prepare_pango_layout_for_draw (item, editable_layout);
-        layout_get_full_size (editable_layout,
-                              &editable_width,
-                              &editable_height,
-                              &editable_dx);
+        measure_label_layout (item, &details->editable_text_layout,
+                              details->editable_text, TRUE, &metrics);
+        editable_width = metrics.width;
+        editable_height = metrics.height;
+        editable_dx = metrics.dx;
+        editable_height_for_entire_text = metrics.height_for_entire_text;
+        editable_height_for_layout = metrics.height_for_layout;
     }
 
     if (have_additional)
     {
-        additional_layout = get_label_layout (&details->additional_text_layout, item, details->additional_text);
-        prepare_pango_layout_for_draw (item, additional_layout);
-        layout_get_full_size (additional_layout,
-                              &additional_width, &additional_height, &additional_dx);
+        measure_label_layout (item, &details->additional_text_layout,
+                              details->additional_text, FALSE, &metrics);
+        additional_width = metrics.width;
+        additional_height = metrics.height;
+        additional_dx = metrics.dx;
     }
 
     details->editable_text_height = editable_height;
@@ -1225,16 +1393,6 @@ measure_label_text (CajaIconCanvasItem *item)
 
     /* extra to make it look nicer */
     details->text_width += TEXT_BACK_PADDING_X*2;
-
-    if (editable_layout)
-    {
-        g_object_unref (editable_layout);
-    }
-
-    if (additional_layout)
-    {
-        g_object_unref (additional_layout);
-    }
 }
 
 static void
@@ -1965,6 +2123,30 @@ caja_icon_canvas_item_draw (EelCanvasItem *item,
 	 (g_ascii_isdigit (*(p+1)) && \
 	  g_ascii_isdigit (*(p+2))))
 
+static PangoFontDescription *
+get_label_font_description (CajaIconCanvasItem *item,
+                            PangoContext *context)
+{
+    CajaIconContainer *container;
+    PangoFontDescription *desc;
+
+    container = CAJA_ICON_CONTAINER (EEL_CANVAS_ITEM (item)->canvas);
+
+    if (container->details->font)
+    {
+        desc = pango_font_description_from_string (container->details->font);
+    }
+    else
+    {
+        desc = pango_font_description_copy (pango_context_get_font_description (context));
+        pango_font_description_set_size (desc,
+                                         pango_font_description_get_size (desc) +
+                                         container->details->font_size_table [container->details->zoom_level]);
+    }
+
+    return desc;
+}
+
 static PangoLayout *
 create_label_layout (CajaIconCanvasItem *item,
                      const char *text)
@@ -2041,18 +2223,7 @@ create_label_layout (CajaIconCanvasItem *item,
     pango_layout_set_attributes (layout, attr_list);
 #endif
 
-    /* Create a font description */
-    if (container->details->font)
-    {
-        desc = pango_font_description_from_string (container->details->font);
-    }
-    else
-    {
-        desc = pango_font_description_copy (pango_context_get_font_description (context));
-        pango_font_description_set_size (desc,
-                                         pango_font_description_get_size (desc) +
-                                         container->details->font_size_table [container->details->zoom_level]);
-    }
+    desc = get_label_font_description (item, context);
     pango_layout_set_font_description (layout, desc);
     pango_font_description_free (desc);
     g_free (zeroified_text);
@@ -285,6 +285,7 @@ icon_free (CajaIcon *icon)
 {
     /* Destroy this canvas item; the parent will unref it. */
     eel_canvas_item_destroy (EEL_CANVAS_ITEM (icon->item));
+    g_free (icon->search_key);
     g_free (icon);
 }
 
@@ -3065,7 +3066,8 @@ compare_icons_by_uri (CajaIconContainer *container,
                       CajaIcon *icon_a,
                       CajaIcon *icon_b)
 {
-    char *uri_a, *uri_b;
+    const char *uri_a, *uri_b;
+    char *free_a, *free_b;
     int result;
 
     g_assert (CAJA_IS_ICON_CONTAINER (container));
@@ -3073,12 +3075,12 @@ compare_icons_by_uri (CajaIconContainer *container,
     g_assert (icon_b != NULL);
     g_assert (icon_a != icon_b);
 
-    uri_a = caja_icon_container_get_icon_uri (container, icon_a);
-    uri_b = caja_icon_container_get_icon_uri (container, icon_b);
+    uri_a = caja_icon_container_peek_icon_uri (container, icon_a, &free_a);
+    uri_b = caja_icon_container_peek_icon_uri (container, icon_b, &free_b);
     result = strcmp (uri_a, uri_b);
     g_assert (result != 0);
-    g_free (uri_a);
-    g_free (uri_b);
+    g_free (free_a);
+    g_free (free_b);
 
     return result;
 }
@@ -4449,6 +4451,12 @@ finalize (GObject *object)
     g_hash_table_destroy (details->icon_set);
     details->icon_set = NULL;
 
+    if (details->search_index != NULL)
+    {
+        g_ptr_array_free (details->search_index, TRUE);
+        details->search_index = NULL;
+    }
+
     g_free (details->font);
 
     if (details->a11y_item_action_queue != NULL)
@@ -5515,76 +5523,258 @@ caja_icon_container_get_icon_text (CajaIconContainer *container,
     klass->get_icon_text (container, data, editable_text, additional_text, include_invisible);
 }
 
+static char *
+make_search_key (const char *text)
+{
+    char *normalized, *key;
+
+    normalized = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+    if (!normalized)
+    {
+        return NULL;
+    }
+    key = g_utf8_casefold (normalized, -1);
+    g_free (normalized);
+
+    return key;
+}
+
+static int
+compare_icons_by_search_key (gconstpointer a, gconstpointer b)
+{
+    const CajaIcon *icon_a, *icon_b;
+    int result;
+
+    icon_a = *(const CajaIcon **) a;
+    icon_b = *(const CajaIcon **) b;
+
+    result = strcmp (icon_a->search_key, icon_b->search_key);
+    if (result != 0)
+    {
+        return result;
+    }
+
+    /* Keep icons with the same name in a stable order */
+    return (icon_a < icon_b) ? -1 : (icon_a > icon_b);
+}
+
+/* Index of the first icon with a search key not less than key */
+static guint
+search_index_lower_bound (GPtrArray *index, const char *key)
+{
+    guint low, high, middle;
+    CajaIcon *icon;
+
+    low = 0;
+    high = index->len;
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+        icon = g_ptr_array_index (index, middle);
+
+        if (strcmp (icon->search_key, key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
 static gboolean
-caja_icon_container_search_iter (CajaIconContainer *container,
-                                 const char *key, gint n)
+search_index_find (GPtrArray *index, CajaIcon *icon, guint *position)
+{
+    guint i;
+
+    for (i = search_index_lower_bound (index, icon->search_key); i < index->len; i++)
+    {
+        CajaIcon *other;
+
+        other = g_ptr_array_index (index, i);
+        if (other == icon)
+        {
+            *position = i;
+            return TRUE;
+        }
+        if (strcmp (other->search_key, icon->search_key) != 0)
+        {
+            break;
+        }
+    }
+
+    return FALSE;
+}
+
+static void
+search_index_remove (CajaIconContainer *container, CajaIcon *icon)
+{
+    guint position;
+
+    if (!container->details->search_index_valid || icon->search_key == NULL)
+    {
+        return;
+    }
+
+    if (search_index_find (container->details->search_index, icon, &position))
+    {
+        g_ptr_array_remove_index (container->details->search_index, position);
+    }
+}
+
+static void
+search_index_insert (CajaIconContainer *container, CajaIcon *icon)
+{
+    GPtrArray *index;
+    guint position;
+
+    if (!container->details->search_index_valid || icon->search_key == NULL)
+    {
+        return;
+    }
+
+    index = container->details->search_index;
+    for (position = search_index_lower_bound (index, icon->search_key);
+         position < index->len &&
+         compare_icons_by_search_key (&g_ptr_array_index (index, position), &icon) < 0;
+         position++)
+    {
+    }
+    g_ptr_array_insert (index, position, icon);
+}
+
+/* Keeps the search key of an icon and its place in the index in sync
+ * with its name, text is NULL if the name is not known.
+ */
+static void
+icon_set_search_key (CajaIconContainer *container,
+                     CajaIcon *icon,
+                     const char *text)
+{
+    char *key;
+
+    key = (text != NULL) ? make_search_key (text) : NULL;
+
+    if (g_strcmp0 (key, icon->search_key) == 0)
+    {
+        g_free (key);
+        return;
+    }
+
+    search_index_remove (container, icon);
+    g_free (icon->search_key);
+    icon->search_key = key;
+    if (key != NULL)
+    {
+        search_index_insert (container, icon);
+    }
+    else
+    {
+        /* Has to be looked up again before the next search */
+        container->details->search_index_valid = FALSE;
+    }
+}
+
+static void
+ensure_search_index (CajaIconContainer *container)
 {
+    CajaIconContainerDetails *details;
     GList *p;
     CajaIcon *icon;
     char *name;
-    int count;
-    char *normalized_key, *case_normalized_key;
-    char *normalized_name, *case_normalized_name;
 
-    g_assert (key != NULL);
-    g_assert (n >= 1);
+    details = container->details;
 
-    normalized_key = g_utf8_normalize (key, -1, G_NORMALIZE_ALL);
-    if (!normalized_key)
+    if (details->search_index_valid)
     {
-        return FALSE;
+        return;
     }
-    case_normalized_key = g_utf8_casefold (normalized_key, -1);
-    g_free (normalized_key);
-    if (!case_normalized_key)
+
+    if (details->search_index == NULL)
     {
-        return FALSE;
+        details->search_index = g_ptr_array_new ();
     }
+    g_ptr_array_set_size (details->search_index, 0);
 
-    icon = NULL;
-    name = NULL;
-    count = 0;
-    for (p = container->details->icons; p != NULL && count != n; p = p->next)
+    for (p = details->icons; p != NULL; p = p->next)
     {
         icon = p->data;
-        caja_icon_container_get_icon_text (container, icon->data, &name,
-                                           NULL, TRUE);
 
-        /* This can happen if a key event is handled really early while
-         * loading the icon container, before the items have all been
-         * updated once.
-         */
-        if (!name)
+        if (icon->search_key == NULL)
         {
-            continue;
-        }
+            name = NULL;
+            caja_icon_container_get_icon_text (container, icon->data, &name,
+                                               NULL, TRUE);
 
-        normalized_name = g_utf8_normalize (name, -1, G_NORMALIZE_ALL);
-        if (!normalized_name)
-        {
-            continue;
-        }
-        case_normalized_name = g_utf8_casefold (normalized_name, -1);
-        g_free (normalized_name);
-        if (!case_normalized_name)
-        {
-            continue;
+            /* This can happen if a key event is handled really early while
+             * loading the icon container, before the items have all been
+             * updated once.
+             */
+            if (!name)
+            {
+                continue;
+            }
+
+            icon->search_key = make_search_key (name);
+            g_free (name);
+            if (icon->search_key == NULL)
+            {
+                continue;
+            }
         }
 
-        if (strncmp (case_normalized_key, case_normalized_name,
-                     strlen (case_normalized_key)) == 0)
+        g_ptr_array_add (details->search_index, icon);
+    }
+
+    g_ptr_array_sort (details->search_index, compare_icons_by_search_key);
+    details->search_index_valid = TRUE;
+}
+
+/* Selects the nth icon, in the order of their names, whose name
+ * starts with key.
+ */
+static gboolean
+caja_icon_container_search_iter (CajaIconContainer *container,
+                                 const char *key, gint n)
+{
+    GPtrArray *index;
+    CajaIcon *icon;
+    char *case_normalized_key;
+    guint position;
+
+    g_assert (key != NULL);
+    g_assert (n >= 1);
+
+    case_normalized_key = make_search_key (key);
+    if (!case_normalized_key)
+    {
+        return FALSE;
+    }
+
+    ensure_search_index (container);
+    index = container->details->search_index;
+
+    /* All icons starting with the key come right after its lower
+     * bound, so the nth match is either n - 1 places further or there
+     * are not that many. */
+    icon = NULL;
+    position = search_index_lower_bound (index, case_normalized_key) + n - 1;
+    if (position < index->len)
+    {
+        icon = g_ptr_array_index (index, position);
+        if (strncmp (case_normalized_key, icon->search_key,
+                     strlen (case_normalized_key)) != 0)
         {
-            count++;
+            icon = NULL;
         }
-
-        g_free (case_normalized_name);
-        g_free (name);
-        name = NULL;
     }
 
     g_free (case_normalized_key);
 
-    if (count == n)
+    if (icon != NULL)
     {
         if (select_one_unselect_others (container, icon))
         {
@@ -7076,6 +7266,8 @@ caja_icon_container_clear (CajaIconContainer *container)
     g_hash_table_destroy (details->icon_set);
     details->icon_set = g_hash_table_new (g_direct_hash, g_direct_equal);
 
+    details->search_index_valid = FALSE;
+
     caja_icon_container_update_scroll_region (container);
 }
 
@@ -7292,6 +7484,7 @@ icon_destroy (CajaIconContainer *container,
     details->icons = g_list_remove (details->icons, icon);
     details->new_icons = g_list_remove (details->new_icons, icon);
     g_hash_table_remove (details->icon_set, icon->data);
+    search_index_remove (container, icon);
 
     was_selected = icon->is_selected;
 
@@ -7678,6 +7871,23 @@ caja_icon_container_update_icon (CajaIconContainer *container,
                          "highlighted_for_drop", icon == details->drop_target,
                          NULL);
 
+    /* At the smallest zoom level there is no visible text, ask for the
+     * name anyway so the search key stays valid. */
+    if (editable_text == NULL)
+    {
+        char *name;
+
+        name = NULL;
+        caja_icon_container_get_icon_text (container, icon->data, &name,
+                                           NULL, TRUE);
+        icon_set_search_key (container, icon, name);
+        g_free (name);
+    }
+    else
+    {
+        icon_set_search_key (container, icon, editable_text);
+    }
+
     caja_icon_canvas_item_set_image (icon->item, pixbuf);
     caja_icon_canvas_item_set_attach_points (icon->item, attach_points, n_attach_points);
     caja_icon_canvas_item_set_emblems (icon->item, emblem_pixbufs);
@@ -7926,6 +8136,10 @@ caja_icon_container_add (CajaIconContainer *container,
 
     g_hash_table_insert (details->icon_set, data, icon);
 
+    /* Icons usually come in large numbers, the index is rather
+     * rebuilt the next time it is needed. */
+    details->search_index_valid = FALSE;
+
     /* Run an idle function to add the icons. */
     schedule_redo_layout (container);
 
@@ -8382,15 +8596,15 @@ caja_icon_container_get_icon_by_uri (CajaIconContainer *container,
     for (p = details->icons; p != NULL; p = p->next)
     {
         CajaIcon *icon;
-        char *icon_uri;
+        const char *icon_uri;
+        char *free_uri;
         gboolean is_match;
 
         icon = p->data;
 
-        icon_uri = caja_icon_container_get_icon_uri
-                   (container, icon);
+        icon_uri = caja_icon_container_peek_icon_uri (container, icon, &free_uri);
         is_match = strcmp (uri, icon_uri) == 0;
-        g_free (icon_uri);
+        g_free (free_uri);
 
         if (is_match)
         {
@@ -8631,6 +8845,28 @@ caja_icon_container_get_icon_uri (CajaIconContainer *container,
     return uri;
 }
 
+/* Like caja_icon_container_get_icon_uri, but borrows the uri from the
+ * icon data when the subclass can. *to_free is set to what the caller
+ * has to free, if anything.
+ */
+const char *
+caja_icon_container_peek_icon_uri (CajaIconContainer *container,
+                                   CajaIcon *icon,
+                                   char **to_free)
+{
+    CajaIconContainerClass *klass;
+
+    klass = CAJA_ICON_CONTAINER_GET_CLASS (container);
+    if (klass->peek_icon_uri != NULL)
+    {
+        *to_free = NULL;
+        return klass->peek_icon_uri (container, icon->data);
+    }
+
+    *to_free = caja_icon_container_get_icon_uri (container, icon);
+    return *to_free;
+}
+
 char *
 caja_icon_container_get_icon_drop_target_uri (CajaIconContainer *container,
         CajaIcon *icon)
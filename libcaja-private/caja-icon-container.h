@@ -177,6 +177,12 @@ typedef struct
     void         (* prioritize_thumbnailing)  (CajaIconContainer *container,
             CajaIconData *data);
 
+    /* Optional, returns a uri owned by the icon data. Used instead
+     * of the get_icon_uri signal where the uri is only looked at.
+     */
+    const char * (* peek_icon_uri)            (CajaIconContainer *container,
+            CajaIconData *data);
+
     /* Queries on icons for subclass/client.
      * These must be implemented => These are signals !
      * The default "do nothing" is not good enough.
@@ -231,7 +231,8 @@ icon_get_data_binder (CajaIcon *icon, gpointer data)
     IconGetDataBinderContext *context;
     EelDRect world_rect;
     EelIRect widget_rect;
-    char *uri;
+    const char *uri;
+    char *uri_to_free;
     CajaIconContainer *container;
 
     context = (IconGetDataBinderContext *)data;
@@ -244,7 +245,7 @@ icon_get_data_binder (CajaIcon *icon, gpointer data)
 
     canvas_rect_world_to_widget (EEL_CANVAS (container), &world_rect, &widget_rect);
 
-    uri = caja_icon_container_get_icon_uri (container, icon);
+    uri = caja_icon_container_peek_icon_uri (container, icon, &uri_to_free);
     if (uri == NULL)
     {
         g_warning ("no URI for one of the iterated icons");
@@ -266,7 +267,7 @@ icon_get_data_binder (CajaIcon *icon, gpointer data)
                        widget_rect.y1 - widget_rect.y0,
                        context->iteratee_data);
 
-    g_free (uri);
+    g_free (uri_to_free);
 
     return TRUE;
 }
@@ -1427,11 +1428,12 @@ caja_icon_dnd_update_drop_target (CajaIconContainer *container,
     if (icon != NULL && (container->details->dnd_info->drag_info.data_type != CAJA_ICON_DND_KEYWORD))
     {
         CajaFile *file;
-        char *uri;
+        const char *uri;
+        char *uri_to_free;
 
-        uri = caja_icon_container_get_icon_uri (container, icon);
+        uri = caja_icon_container_peek_icon_uri (container, icon, &uri_to_free);
         file = caja_file_get_by_uri (uri);
-        g_free (uri);
+        g_free (uri_to_free);
 
         if (!caja_drag_can_accept_info (file,
                                         container->details->dnd_info->drag_info.data_type,
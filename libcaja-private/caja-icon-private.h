@@ -55,6 +55,11 @@ typedef struct
     /* Scale factor (stretches icon). */
     double scale;
 
+    /* Normalized and casefolded name for type-ahead find, NULL if
+     * not known yet.
+     */
+    char *search_key;
+
     /* Whether this item is selected. */
     eel_boolean_bit is_selected : 1;
 
@@ -284,6 +289,11 @@ struct CajaIconContainerDetails
     gboolean disable_popdown;
     gboolean imcontext_changed;
     int selected_iter;
+    /* Icons with a search key, sorted by it. Built when needed and
+     * kept up to date until icons are added.
+     */
+    GPtrArray *search_index;
+    gboolean search_index_valid;
     GtkWidget *search_window;
     GtkWidget *search_entry;
     guint search_entry_changed_id;
@@ -305,6 +315,9 @@ void          caja_icon_container_select_list_unselect_others (CajaIconContainer
         GList                 *icons);
 char *        caja_icon_container_get_icon_uri                (CajaIconContainer *container,
         CajaIcon          *icon);
+const char *  caja_icon_container_peek_icon_uri               (CajaIconContainer *container,
+        CajaIcon          *icon,
+        char             **to_free);
 char *        caja_icon_container_get_icon_drop_target_uri    (CajaIconContainer *container,
         CajaIcon          *icon);
 void          caja_icon_container_update_icon                 (CajaIconContainer *container,
@@ -47,6 +47,7 @@ void caja_run_lib_self_checks (void);
 	macro (caja_self_check_directory) \
 	macro (caja_self_check_file) \
 	macro (caja_self_check_icon_container) \
+	macro (caja_self_check_query) \
 /* Add new self-check functions to the list above this line. */
 
 /* Generate prototypes for all the functions. */
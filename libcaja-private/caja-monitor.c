@@ -26,19 +26,59 @@
 
 #include <config.h>
 #include "caja-monitor.h"
+#include "caja-directory-private.h"
 #include "caja-file-changes-queue.h"
 #include "caja-file-utilities.h"
 
 #include <gio/gio.h>
 
+/* Events are counted per directory over windows of one second. Above
+ * MONITOR_BUSY_RATE events per window they are held back and deduplicated
+ * for a debounce delay that doubles with every busy window, and halves
+ * again once the directory calms down. Above MONITOR_STORM_RATE single
+ * events are no longer useful, they are dropped and the directory is
+ * reloaded every MONITOR_STORM_INTERVAL instead.
+ */
+#define MONITOR_RATE_WINDOW (1 * G_USEC_PER_SEC)
+#define MONITOR_BUSY_RATE 50
+#define MONITOR_STORM_RATE 2000
+#define MONITOR_MIN_DEBOUNCE 50 /* ms */
+#define MONITOR_MAX_DEBOUNCE 1000 /* ms */
+#define MONITOR_STORM_INTERVAL 2000 /* ms */
+
+typedef enum
+{
+    MONITOR_EVENT_ADDED,
+    MONITOR_EVENT_CHANGED,
+    MONITOR_EVENT_REMOVED
+} MonitorEventKind;
+
+typedef struct
+{
+    MonitorEventKind kind;
+    GFile *file;
+} MonitorEvent;
+
 struct CajaMonitor
 {
     GFileMonitor *monitor;
     GVolumeMonitor *volume_monitor;
     GMount *mount;
     GFile *location;
+
+    GFile *directory;
+    gint64 window_start;
+    guint window_events;
+    guint debounce;
+    gboolean storm;
+    gboolean reload_pending;
+    guint flush_id;
+    GQueue pending; /* of MonitorEvent, oldest first */
+    GHashTable *pending_kinds; /* GFile -> last pending MonitorEventKind + 1 */
 };
 
+static guint absorbed_events = 0;
+
 gboolean
 caja_monitor_active (void)
 {
@@ -97,6 +137,154 @@ mount_removed (GVolumeMonitor *volume_monitor,
     }
 }
 
+static void
+queue_event (MonitorEventKind kind,
+             GFile *file)
+{
+    switch (kind)
+    {
+    case MONITOR_EVENT_ADDED:
+        caja_file_changes_queue_file_added (file);
+        break;
+    case MONITOR_EVENT_CHANGED:
+        caja_file_changes_queue_file_changed (file);
+        break;
+    case MONITOR_EVENT_REMOVED:
+        caja_file_changes_queue_file_removed (file);
+        break;
+    }
+}
+
+static void
+clear_pending_events (CajaMonitor *monitor)
+{
+    MonitorEvent *event;
+
+    while ((event = g_queue_pop_head (&monitor->pending)) != NULL)
+    {
+        g_object_unref (event->file);
+        g_free (event);
+    }
+    g_hash_table_remove_all (monitor->pending_kinds);
+}
+
+static gboolean
+flush_events_callback (gpointer callback_data)
+{
+    CajaMonitor *monitor;
+    CajaDirectory *directory;
+    MonitorEvent *event;
+
+    monitor = callback_data;
+    monitor->flush_id = 0;
+
+    if (monitor->reload_pending)
+    {
+        directory = caja_directory_get_existing (monitor->directory);
+        if (directory != NULL &&
+                caja_directory_is_file_list_monitored (directory) &&
+                !caja_directory_are_all_files_seen (directory))
+        {
+            /* A reload would cancel the load still enumerating, and a
+             * big busy directory would never finish. Try again once
+             * it is done, it can have missed changes made meanwhile. */
+            caja_directory_unref (directory);
+            monitor->flush_id = g_timeout_add (MONITOR_STORM_INTERVAL,
+                                               flush_events_callback, monitor);
+            return FALSE;
+        }
+
+        monitor->reload_pending = FALSE;
+
+        if (directory != NULL)
+        {
+            caja_directory_force_reload (directory);
+            caja_directory_unref (directory);
+        }
+    }
+
+    while ((event = g_queue_pop_head (&monitor->pending)) != NULL)
+    {
+        queue_event (event->kind, event->file);
+        g_object_unref (event->file);
+        g_free (event);
+    }
+    g_hash_table_remove_all (monitor->pending_kinds);
+
+    schedule_call_consume_changes ();
+
+    return FALSE;
+}
+
+static void
+schedule_flush_events (CajaMonitor *monitor)
+{
+    if (monitor->flush_id == 0)
+    {
+        monitor->flush_id = g_timeout_add (monitor->storm ? MONITOR_STORM_INTERVAL : monitor->debounce,
+                                           flush_events_callback, monitor);
+    }
+}
+
+static void
+update_event_rate (CajaMonitor *monitor)
+{
+    gint64 now, quiet_windows;
+
+    now = g_get_monotonic_time ();
+    if (now - monitor->window_start >= MONITOR_RATE_WINDOW)
+    {
+        /* The windows between the last one and now had no events */
+        quiet_windows = (now - monitor->window_start) / MONITOR_RATE_WINDOW - 1;
+
+        if (monitor->window_events > MONITOR_BUSY_RATE)
+        {
+            monitor->debounce = MIN (MAX (monitor->debounce * 2, MONITOR_MIN_DEBOUNCE),
+                                     MONITOR_MAX_DEBOUNCE);
+        }
+        else if (monitor->window_events < MONITOR_BUSY_RATE / 2)
+        {
+            monitor->debounce /= 2;
+            if (monitor->debounce < MONITOR_MIN_DEBOUNCE)
+            {
+                monitor->debounce = 0;
+            }
+        }
+        monitor->storm = monitor->window_events > MONITOR_STORM_RATE;
+
+        if (quiet_windows > 0)
+        {
+            monitor->storm = FALSE;
+            for (; quiet_windows > 0 && monitor->debounce > 0; quiet_windows--)
+            {
+                monitor->debounce /= 2;
+                if (monitor->debounce < MONITOR_MIN_DEBOUNCE)
+                {
+                    monitor->debounce = 0;
+                }
+            }
+        }
+
+        monitor->window_start = now;
+        monitor->window_events = 0;
+    }
+
+    monitor->window_events++;
+
+    if (monitor->debounce == 0 && monitor->window_events > MONITOR_BUSY_RATE)
+    {
+        monitor->debounce = MONITOR_MIN_DEBOUNCE;
+    }
+
+    if (!monitor->storm && monitor->window_events > MONITOR_STORM_RATE)
+    {
+        /* The reload picks up everything still pending */
+        absorbed_events += g_queue_get_length (&monitor->pending);
+        clear_pending_events (monitor);
+        monitor->storm = TRUE;
+    }
+}
+
 static void
 dir_changed (GFileMonitor* monitor,
              GFile *child,
@@ -104,43 +292,83 @@ dir_changed (GFileMonitor* monitor,
              GFileMonitorEvent event_type,
              gpointer user_data)
 {
-    char *uri, *to_uri;
+    CajaMonitor *caja_monitor;
+    MonitorEventKind kind;
+    MonitorEvent *event;
+    gpointer last_kind;
 
-    uri = g_file_get_uri (child);
-    to_uri = NULL;
-    if (other_file)
-    {
-        to_uri = g_file_get_uri (other_file);
-    }
+    caja_monitor = user_data;
 
     switch (event_type)
     {
     default:
     case G_FILE_MONITOR_EVENT_CHANGED:
         /* ignore */
-        break;
+        return;
     case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
-        caja_file_changes_queue_file_changed (child);
+        kind = MONITOR_EVENT_CHANGED;
         break;
     case G_FILE_MONITOR_EVENT_DELETED:
-        caja_file_changes_queue_file_removed (child);
+        kind = MONITOR_EVENT_REMOVED;
         break;
     case G_FILE_MONITOR_EVENT_CREATED:
-        caja_file_changes_queue_file_added (child);
+        kind = MONITOR_EVENT_ADDED;
         break;
 
     case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
         /* TODO: Do something */
-        break;
+        return;
     case G_FILE_MONITOR_EVENT_UNMOUNTED:
         /* TODO: Do something */
-        break;
+        return;
     }
 
-    g_free (uri);
-    g_free (to_uri);
-    schedule_call_consume_changes ();
+    update_event_rate (caja_monitor);
+
+    if (caja_monitor->storm)
+    {
+        absorbed_events++;
+        caja_monitor->reload_pending = TRUE;
+        schedule_flush_events (caja_monitor);
+        return;
+    }
+
+    if (caja_monitor->debounce == 0 &&
+            g_queue_is_empty (&caja_monitor->pending))
+    {
+        queue_event (kind, child);
+        schedule_call_consume_changes ();
+        return;
+    }
+
+    /* A change of a file that is already going to be added or
+     * changed doesn't tell anything new. */
+    last_kind = g_hash_table_lookup (caja_monitor->pending_kinds, child);
+    if (last_kind != NULL &&
+            kind == MONITOR_EVENT_CHANGED &&
+            GPOINTER_TO_INT (last_kind) - 1 != MONITOR_EVENT_REMOVED)
+    {
+        absorbed_events++;
+    }
+    else
+    {
+        event = g_new (MonitorEvent, 1);
+        event->kind = kind;
+        event->file = g_object_ref (child);
+        g_queue_push_tail (&caja_monitor->pending, event);
+
+        g_hash_table_replace (caja_monitor->pending_kinds,
+                              event->file, GINT_TO_POINTER (kind + 1));
+    }
+
+    schedule_flush_events (caja_monitor);
+}
+
+guint
+caja_monitor_get_absorbed_events (void)
+{
+    return absorbed_events;
 }
 
 CajaMonitor *
@@ -150,6 +378,11 @@ caja_monitor_directory (GFile *location)
     CajaMonitor *ret;
 
     ret = g_new0 (CajaMonitor, 1);
+    ret->directory = g_object_ref (location);
+    ret->window_start = g_get_monotonic_time ();
+    g_queue_init (&ret->pending);
+    ret->pending_kinds = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
     dir_monitor = g_file_monitor_directory (location, G_FILE_MONITOR_WATCH_MOUNTS, NULL, NULL);
 
     if (dir_monitor != NULL) {
@@ -167,10 +400,6 @@ caja_monitor_directory (GFile *location)
                   G_CALLBACK (dir_changed), ret);
     }
 
-    if (ret->monitor) {
-        g_signal_connect (ret->monitor, "changed", (GCallback)dir_changed, ret);
-    }
-
     if (ret->volume_monitor != NULL) {
         g_signal_connect (ret->volume_monitor, "mount-removed",
                     G_CALLBACK (mount_removed), ret);
@@ -195,6 +424,14 @@ caja_monitor_cancel (CajaMonitor *monitor)
         g_object_unref (monitor->volume_monitor);
     }
 
+    if (monitor->flush_id != 0)
+    {
+        g_source_remove (monitor->flush_id);
+    }
+    clear_pending_events (monitor);
+    g_hash_table_destroy (monitor->pending_kinds);
+    g_object_unref (monitor->directory);
+
     g_clear_object (&monitor->location);
     g_clear_object (&monitor->mount);
     g_free (monitor);
@@ -35,4 +35,8 @@ gboolean         caja_monitor_active    (void);
 CajaMonitor *caja_monitor_directory (GFile *location);
 void             caja_monitor_cancel    (CajaMonitor *monitor);
 
+/* Number of events dropped because they were redundant or because
+ * their directory was reloaded instead */
+guint            caja_monitor_get_absorbed_events (void);
+
 #endif /* CAJA_MONITOR_H */
@@ -59,6 +59,12 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 struct _ProgressWidgetData;
 
+typedef struct
+{
+    char *id;
+    char *name;
+} ProgressDevice;
+
 struct _CajaProgressInfo
 {
     GObject parent_instance;
@@ -79,6 +85,10 @@ struct _CajaProgressInfo
     gboolean waiting;
     GCond waiting_c;
 
+    /* Devices touched by the operation, used to decide
+       which queued operations may run concurrently */
+    GList *devices;
+
     GSource *idle_source;
     gboolean source_is_now;
 
@@ -117,6 +127,14 @@ caja_get_all_progress_info (void)
     return l;
 }
 
+static void
+progress_device_free (ProgressDevice *device)
+{
+    g_free (device->id);
+    g_free (device->name);
+    g_free (device);
+}
+
 static void
 caja_progress_info_finalize (GObject *object)
 {
@@ -126,6 +144,7 @@ caja_progress_info_finalize (GObject *object)
 
     g_free (info->status);
     g_free (info->details);
+    g_list_free_full (info->devices, (GDestroyNotify) progress_device_free);
     g_object_unref (info->cancellable);
 
     if (G_OBJECT_CLASS (caja_progress_info_parent_class)->finalize)
@@ -296,22 +315,25 @@ typedef struct _ProgressWidgetData
     GtkWidget *btstart;
     GtkWidget *btqueue;
     ProgressWidgetState state;
+    char *waiting_for;
 } ProgressWidgetData;
 
 static void
 progress_widget_data_free (ProgressWidgetData *data)
 {
     g_object_unref (data->info);
+    g_free (data->waiting_for);
     g_free (data);
 }
 
 static void
 update_data (ProgressWidgetData *data)
 {
-    char *status, *details, *curstat;
+    char *status, *details, *curstat, *queued_for;
     char *markup;
 
     status = caja_progress_info_get_status (data->info);
+    queued_for = NULL;
 
     switch (data->state) {
         case STATE_PAUSED:
@@ -321,7 +343,13 @@ update_data (ProgressWidgetData *data)
             curstat = _("pausing");
             break;
         case STATE_QUEUED:
-            curstat = _("queued");
+            if (data->waiting_for != NULL) {
+                queued_for = g_strdup_printf (_("queued, waiting for %s"),
+                                              data->waiting_for);
+                curstat = queued_for;
+            } else {
+                curstat = _("queued");
+            }
             break;
         case STATE_QUEUING:
             curstat = _("queuing");
@@ -337,6 +365,7 @@ update_data (ProgressWidgetData *data)
         status = g_strconcat (status, " \xE2\x80\x94 ", curstat, NULL);
         g_free (t);
     }
+    g_free (queued_for);
 
     gtk_label_set_text (data->status, status);
     g_free (status);
@@ -355,50 +384,70 @@ get_widgets_container (void)
     GtkWidget * window = get_progress_window ();
     return gtk_bin_get_child (GTK_BIN (window));
 }
-static void
-foreach_get_running_operations (GtkWidget * widget, int * n)
+static gboolean
+progress_info_has_devices (CajaProgressInfo *info)
 {
-    ProgressWidgetData *data = (ProgressWidgetData*) g_object_get_data (
-                G_OBJECT(widget), "data");
+    gboolean res;
+
+    G_LOCK (progress_info);
+    res = info->devices != NULL;
+    G_UNLOCK (progress_info);
 
-    if (! is_op_paused (data->state))
-        (*n)++;
+    return res;
 }
 
-static int
-get_running_operations (void)
+static void
+device_usage_add (GHashTable *usage, CajaProgressInfo *info)
 {
-    GtkWidget * container = get_widgets_container();
-    int n = 0;
+    GList *l;
+    int n;
+
+    G_LOCK (progress_info);
+    for (l = info->devices; l != NULL; l = l->next) {
+        ProgressDevice *device = l->data;
 
-    gtk_container_foreach (GTK_CONTAINER(container),
-                        (GtkCallback)foreach_get_running_operations, &n);
-    return n;
+        n = GPOINTER_TO_INT (g_hash_table_lookup (usage, device->id));
+        g_hash_table_insert (usage, g_strdup (device->id), GINT_TO_POINTER (n + 1));
+    }
+    G_UNLOCK (progress_info);
 }
 
+/* Mark all devices of a waiting operation as busy, so that operations
+   queued after it cannot overtake it on the same device */
 static void
-foreach_get_queued_widget (GtkWidget * widget, GtkWidget ** out)
+device_usage_reserve (GHashTable *usage, CajaProgressInfo *info, int limit)
 {
-    if (*out == NULL) {
-        ProgressWidgetData *data;
+    GList *l;
 
-        data = (ProgressWidgetData*) g_object_get_data (
-                G_OBJECT(widget), "data");
+    G_LOCK (progress_info);
+    for (l = info->devices; l != NULL; l = l->next) {
+        ProgressDevice *device = l->data;
 
-        if (data->state == STATE_QUEUED || data->state == STATE_QUEUING)
-            *out = widget;
+        g_hash_table_insert (usage, g_strdup (device->id), GINT_TO_POINTER (limit));
     }
+    G_UNLOCK (progress_info);
 }
 
-static GtkWidget *
-get_first_queued_widget (void)
+/* Returns the name of the first device of info with no free slot left,
+   or NULL if the operation can run now */
+static char *
+device_usage_get_bottleneck (GHashTable *usage, CajaProgressInfo *info, int limit)
 {
-    GtkWidget * container = get_widgets_container();
-    GtkWidget * out = NULL;
+    GList *l;
+    char *res;
+
+    res = NULL;
+
+    G_LOCK (progress_info);
+    for (l = info->devices; l != NULL && res == NULL; l = l->next) {
+        ProgressDevice *device = l->data;
+
+        if (GPOINTER_TO_INT (g_hash_table_lookup (usage, device->id)) >= limit)
+            res = g_strdup (device->name);
+    }
+    G_UNLOCK (progress_info);
 
-    gtk_container_foreach (GTK_CONTAINER(container),
-                (GtkCallback)foreach_get_queued_widget, &out);
-    return out;
+    return res;
 }
 
 static void
@@ -565,22 +614,75 @@ widget_state_transit_to (ProgressWidgetData *data,
     update_data (data);
 }
 
+/* Start every queued operation whose devices have a free slot.
+ * Operations that don't know their devices only run alone, and
+ * nothing else runs next to them. */
 static void
 update_queue (void)
 {
-    if (get_running_operations () == 0) {
-        GtkWidget *next;
+    GList *children, *l;
+    GHashTable *usage;
+    ProgressWidgetData *data;
+    int limit, n_running;
+    gboolean exclusive_running, can_start;
+    char *bottleneck;
+
+    limit = MAX (1, g_settings_get_int (caja_preferences,
+                                        CAJA_PREFERENCES_FILE_OPERATIONS_PER_DEVICE));
+    usage = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    n_running = 0;
+    exclusive_running = FALSE;
+
+    children = gtk_container_get_children (GTK_CONTAINER (get_widgets_container ()));
+
+    for (l = children; l != NULL; l = l->next) {
+        data = (ProgressWidgetData*) g_object_get_data (G_OBJECT (l->data), "data");
+
+        if (is_op_paused (data->state))
+            continue;
+
+        n_running++;
+        if (progress_info_has_devices (data->info))
+            device_usage_add (usage, data->info);
+        else
+            exclusive_running = TRUE;
+    }
+
+    for (l = children; l != NULL; l = l->next) {
+        data = (ProgressWidgetData*) g_object_get_data (G_OBJECT (l->data), "data");
 
-        next = get_first_queued_widget ();
+        if (data->state != STATE_QUEUED)
+            continue;
+
+        bottleneck = NULL;
+        if (!progress_info_has_devices (data->info)) {
+            can_start = (n_running == 0);
+        } else if (exclusive_running) {
+            can_start = FALSE;
+        } else {
+            bottleneck = device_usage_get_bottleneck (usage, data->info, limit);
+            can_start = (bottleneck == NULL);
+        }
 
-        if (next != NULL) {
-            ProgressWidgetData *data;
+        g_free (data->waiting_for);
+        data->waiting_for = bottleneck;
+
+        if (can_start) {
+            n_running++;
+            if (progress_info_has_devices (data->info))
+                device_usage_add (usage, data->info);
+            else
+                exclusive_running = TRUE;
 
-            data = (ProgressWidgetData*) g_object_get_data (
-                    G_OBJECT(next), "data");
             widget_state_transit_to (data, STATE_RUNNING);
+        } else {
+            device_usage_reserve (usage, data->info, limit);
+            update_data (data);
         }
     }
+
+    g_list_free (children);
+    g_hash_table_destroy (usage);
 }
 
 static void
@@ -927,7 +1029,9 @@ handle_new_progress_info (CajaProgressInfo *info)
 
     n_progress_ops++;
 
-    if (info->waiting && get_running_operations () > 0)
+    /* Waiting operations go through the queue, which
+       starts them right away if their devices are free */
+    if (info->waiting)
         widget_state_transit_to (info->widget, STATE_QUEUED);
     else
         widget_state_transit_to (info->widget, STATE_RUNNING);
@@ -956,13 +1060,6 @@ new_op_started (CajaProgressInfo *info)
     if (!caja_progress_info_get_is_finished (info)) {
         handle_new_progress_info (info);
 
-        /* Start the job when no other job is running */
-        // TODO use user defined policies
-        if (info->waiting) {
-            if (get_running_operations () == 0)
-                progress_info_set_waiting (info, FALSE);
-        }
-
         g_timeout_add_seconds (2,
                            (GSourceFunc)delayed_window_showup,
                            g_object_ref (info));
@@ -1423,3 +1520,31 @@ caja_progress_info_set_progress (CajaProgressInfo *info,
 
     G_UNLOCK (progress_info);
 }
+
+void
+caja_progress_info_add_device (CajaProgressInfo *info,
+                               const char       *device_id,
+                               const char       *device_name)
+{
+    ProgressDevice *device;
+    GList *l;
+
+    g_return_if_fail (device_id != NULL);
+
+    G_LOCK (progress_info);
+
+    for (l = info->devices; l != NULL; l = l->next) {
+        device = l->data;
+        if (strcmp (device->id, device_id) == 0)
+            break;
+    }
+
+    if (l == NULL) {
+        device = g_new0 (ProgressDevice, 1);
+        device->id = g_strdup (device_id);
+        device->name = g_strdup (device_name != NULL ? device_name : device_id);
+        info->devices = g_list_append (info->devices, device);
+    }
+
+    G_UNLOCK (progress_info);
+}
@@ -81,5 +81,8 @@ void          caja_progress_info_set_progress    (CajaProgressInfo *info,
         double                current,
         double                total);
 void          caja_progress_info_pulse_progress  (CajaProgressInfo *info);
+void          caja_progress_info_add_device      (CajaProgressInfo *info,
+        const char           *device_id,
+        const char           *device_name);
 
 #endif /* CAJA_PROGRESS_INFO_H */
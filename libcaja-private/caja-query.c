@@ -30,6 +30,7 @@
 
 #include "caja-query.h"
 #include "caja-file-utilities.h"
+#include "caja-lib-self-check-functions.h"
 
 struct CajaQueryDetails
 {
@@ -155,6 +156,113 @@ caja_query_add_tag (CajaQuery *query, const char *tag)
     query->details->tags = g_list_append (query->details->tags, lower_case);
 }
 
+/* The words of the text, normalized and lower case, that each have to
+ * appear in the name of a matching file.
+ */
+char **
+caja_query_get_words (CajaQuery *query)
+{
+    char *normalized, *lower;
+    char **words;
+
+    if (query->details->text == NULL)
+    {
+        return g_new0 (char *, 1);
+    }
+
+    normalized = g_utf8_normalize (query->details->text, -1, G_NORMALIZE_NFD);
+    lower = g_utf8_strdown (normalized, -1);
+    words = g_strsplit (lower, " ", -1);
+    g_free (normalized);
+    g_free (lower);
+
+    return words;
+}
+
+static gboolean
+string_list_contains (GList *list, const char *string)
+{
+    return g_list_find_custom (list, string, (GCompareFunc) g_strcmp0) != NULL;
+}
+
+/* Whether every file matching query also matches previous, so that the
+ * hits of previous can be narrowed down instead of searching again.
+ * Only the name and the file types can be narrowed, everything else has
+ * to be the same.
+ */
+gboolean
+caja_query_is_refinement_of (CajaQuery *query, CajaQuery *previous)
+{
+    char **words, **previous_words;
+    GList *l;
+    gboolean result;
+    int i, j;
+
+    g_return_val_if_fail (CAJA_IS_QUERY (query), FALSE);
+    g_return_val_if_fail (CAJA_IS_QUERY (previous), FALSE);
+
+    if (g_strcmp0 (query->details->location_uri, previous->details->location_uri) != 0 ||
+        g_strcmp0 (query->details->contained_text, previous->details->contained_text) != 0 ||
+        query->details->timestamp != previous->details->timestamp ||
+        query->details->size != previous->details->size)
+    {
+        return FALSE;
+    }
+
+    if (g_list_length (query->details->tags) != g_list_length (previous->details->tags))
+    {
+        return FALSE;
+    }
+    for (l = query->details->tags; l != NULL; l = l->next)
+    {
+        if (!string_list_contains (previous->details->tags, l->data))
+        {
+            return FALSE;
+        }
+    }
+
+    /* No types at all means any type */
+    if (previous->details->mime_types != NULL)
+    {
+        if (query->details->mime_types == NULL)
+        {
+            return FALSE;
+        }
+        for (l = query->details->mime_types; l != NULL; l = l->next)
+        {
+            if (!string_list_contains (previous->details->mime_types, l->data))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    /* A name containing all the new words contains all the old ones
+     * if each old word is part of some new word.
+     */
+    words = caja_query_get_words (query);
+    previous_words = caja_query_get_words (previous);
+
+    result = TRUE;
+    for (i = 0; result && previous_words[i] != NULL; i++)
+    {
+        result = FALSE;
+        for (j = 0; words[j] != NULL; j++)
+        {
+            if (strstr (words[j], previous_words[i]) != NULL)
+            {
+                result = TRUE;
+                break;
+            }
+        }
+    }
+
+    g_strfreev (words);
+    g_strfreev (previous_words);
+
+    return result;
+}
+
 char *
 caja_query_to_readable_string (CajaQuery *query)
 {
@@ -483,3 +591,79 @@ char *caja_query_get_contained_text (CajaQuery *query)
 {
     return g_strdup (query->details->contained_text);
 }
+
+#if !defined (CAJA_OMIT_SELF_CHECK)
+
+static CajaQuery *
+make_self_check_query (const char *text, const char *mime_types)
+{
+    CajaQuery *query;
+    char **types;
+    int i;
+
+    query = caja_query_new ();
+    caja_query_set_text (query, text);
+
+    if (mime_types != NULL)
+    {
+        types = g_strsplit (mime_types, ",", -1);
+        for (i = 0; types[i] != NULL; i++)
+        {
+            caja_query_add_mime_type (query, types[i]);
+        }
+        g_strfreev (types);
+    }
+
+    return query;
+}
+
+static gboolean
+self_check_is_refinement_of (const char *text, const char *mime_types,
+                             const char *previous_text, const char *previous_mime_types)
+{
+    CajaQuery *query, *previous;
+    gboolean result;
+
+    query = make_self_check_query (text, mime_types);
+    previous = make_self_check_query (previous_text, previous_mime_types);
+    result = caja_query_is_refinement_of (query, previous);
+    g_object_unref (query);
+    g_object_unref (previous);
+
+    return result;
+}
+
+void
+caja_self_check_query (void)
+{
+    /* words */
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foobar", NULL, "foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo bar", NULL, "foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("bar foo", NULL, "foo bar", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foobar", NULL, "foo bar", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("FOO", NULL, "foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "foobar", NULL), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "foo bar", NULL), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("fo ob", NULL, "foob", NULL), FALSE);
+
+    /* empty and duplicate words */
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("", NULL, "", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("", NULL, "foo", NULL), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo  bar", NULL, "foo bar", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "foo foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo foo", NULL, "foo", NULL), TRUE);
+
+    /* mime types */
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "text/plain", "foo", NULL), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", NULL, "foo", "text/plain"), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "text/plain", "foo", "text/plain,image/png"), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "text/plain,image/png", "foo", "image/png,text/plain"), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "text/plain,image/png", "foo", "text/plain"), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "image/png", "foo", "text/plain"), FALSE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foobar", "text/plain", "foo", "text/plain,image/png"), TRUE);
+    EEL_CHECK_BOOLEAN_RESULT (self_check_is_refinement_of ("foo", "text/plain", "foobar", "text/plain,image/png"), FALSE);
+}
+
+#endif /* !CAJA_OMIT_SELF_CHECK */
@@ -65,6 +65,9 @@ GList *        caja_query_get_mime_types     (CajaQuery *query);
 void           caja_query_set_mime_types     (CajaQuery *query, GList *mime_types);
 void           caja_query_add_mime_type      (CajaQuery *query, const char *mime_type);
 
+char **        caja_query_get_words          (CajaQuery *query);
+gboolean       caja_query_is_refinement_of   (CajaQuery *query, CajaQuery *previous);
+
 char *         caja_query_to_readable_string (CajaQuery *query);
 CajaQuery *    caja_query_load               (char *file);
 gboolean       caja_query_save               (CajaQuery *query, char *file);
@@ -223,7 +223,11 @@ caja_search_directory_file_init (CajaSearchDirectoryFile *search_file)
     file->details->file_info_is_up_to_date = TRUE;
 
     file->details->custom_icon = NULL;
-    file->details->activation_uri = NULL;
+    if (file->details->cold != NULL)
+    {
+        g_free (file->details->cold->activation_uri);
+        file->details->cold->activation_uri = NULL;
+    }
     file->details->got_link_info = TRUE;
     file->details->link_info_is_up_to_date = TRUE;
 
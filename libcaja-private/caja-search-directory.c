@@ -37,6 +37,17 @@
 #include "caja-file-utilities.h"
 #include "caja-search-engine.h"
 
+/* Seconds the results of a search nobody watches are kept, views
+ * remove their monitors and add them again while reloading.
+ */
+#define SEARCH_STOP_DELAY 5
+
+typedef struct
+{
+    char **words;
+    GList *mime_types;
+} SearchFilter;
+
 struct CajaSearchDirectoryDetails
 {
     CajaQuery *query;
@@ -47,6 +58,13 @@ struct CajaSearchDirectoryDetails
 
     gboolean search_running;
     gboolean search_finished;
+    guint stop_timeout_id;
+
+    /* The query the files were found with, and the filter for hits of
+     * a running search that has been refined since.
+     */
+    CajaQuery *engine_query;
+    SearchFilter *hit_filter;
 
     GList *files;
 
@@ -135,33 +153,304 @@ reset_file_list (CajaSearchDirectory *search)
     search->details->files = NULL;
 }
 
+static SearchFilter *
+search_filter_new (CajaQuery *query)
+{
+    SearchFilter *filter;
+
+    filter = g_new0 (SearchFilter, 1);
+    filter->words = caja_query_get_words (query);
+    filter->mime_types = caja_query_get_mime_types (query);
+
+    return filter;
+}
+
+static void
+search_filter_free (SearchFilter *filter)
+{
+    g_strfreev (filter->words);
+    g_list_free_full (filter->mime_types, g_free);
+    g_free (filter);
+}
+
+/* Same checks as the simple search engine does on the file info */
+static gboolean
+search_filter_matches (SearchFilter *filter, CajaFile *file)
+{
+    char *display_name, *normalized, *lower_name;
+    gboolean hit;
+    int i;
+
+    display_name = caja_file_get_display_name (file);
+    normalized = g_utf8_normalize (display_name, -1, G_NORMALIZE_NFD);
+    lower_name = g_utf8_strdown (normalized, -1);
+    g_free (display_name);
+    g_free (normalized);
+
+    hit = TRUE;
+    for (i = 0; filter->words[i] != NULL; i++)
+    {
+        if (strstr (lower_name, filter->words[i]) == NULL)
+        {
+            hit = FALSE;
+            break;
+        }
+    }
+    g_free (lower_name);
+
+    if (hit && filter->mime_types != NULL)
+    {
+        char *mime_type;
+        GList *l;
+
+        mime_type = caja_file_get_mime_type (file);
+        hit = FALSE;
+
+        for (l = filter->mime_types; l != NULL; l = l->next)
+        {
+            if (g_content_type_equals (mime_type, l->data))
+            {
+                hit = TRUE;
+                break;
+            }
+        }
+        g_free (mime_type);
+    }
+
+    return hit;
+}
+
+static void
+set_engine_query (CajaSearchDirectory *search, CajaQuery *query)
+{
+    if (query != NULL)
+    {
+        g_object_ref (query);
+    }
+    if (search->details->engine_query != NULL)
+    {
+        g_object_unref (search->details->engine_query);
+    }
+    search->details->engine_query = query;
+
+    if (search->details->hit_filter != NULL)
+    {
+        search_filter_free (search->details->hit_filter);
+        search->details->hit_filter = NULL;
+    }
+}
+
+static void
+start_search (CajaSearchDirectory *search)
+{
+    search->details->search_running = TRUE;
+    search->details->search_finished = FALSE;
+    ensure_search_engine (search);
+    caja_search_engine_set_query (search->details->engine, search->details->query);
+    set_engine_query (search, search->details->query);
+
+    reset_file_list (search);
+
+    caja_search_engine_start (search->details->engine);
+}
+
+static void
+stop_search (CajaSearchDirectory *search)
+{
+    if (search->details->stop_timeout_id != 0)
+    {
+        g_source_remove (search->details->stop_timeout_id);
+        search->details->stop_timeout_id = 0;
+    }
+
+    search->details->search_running = FALSE;
+    caja_search_engine_stop (search->details->engine);
+    set_engine_query (search, NULL);
+
+    reset_file_list (search);
+}
+
+static void
+remove_files (CajaSearchDirectory *search, GList *files)
+{
+    GList *list, *monitor_list;
+    SearchMonitor *monitor;
+    CajaFile *file;
+
+    for (list = files; list != NULL; list = list->next)
+    {
+        file = list->data;
+
+        for (monitor_list = search->details->monitor_list; monitor_list;
+                monitor_list = monitor_list->next)
+        {
+            monitor = monitor_list->data;
+            /* Remove monitors */
+            caja_file_monitor_remove (file, monitor);
+        }
+
+        g_signal_handlers_disconnect_by_func (file, file_changed, search);
+    }
+
+    /* The views drop files that are no longer in the directory */
+    caja_directory_emit_files_changed (CAJA_DIRECTORY (search), files);
+
+    file = caja_directory_get_corresponding_file (CAJA_DIRECTORY (search));
+    caja_file_emit_changed (file);
+    caja_file_unref (file);
+}
+
+/* Narrow down the files found for the previous query, and make a search
+ * that is still running only look for the new one from now on.
+ */
+static gboolean
+refine_search (CajaSearchDirectory *search)
+{
+    SearchFilter *filter;
+    GList *list, *kept, *removed, *previous_types;
+    CajaFile *file;
+    gboolean types_changed;
+
+    /* Indexed engines also match on things we can't check here, like
+     * the contents, and they are fast anyway. */
+    if (search->details->engine_query == NULL ||
+        caja_search_engine_is_indexed (search->details->engine) ||
+        !caja_query_is_refinement_of (search->details->query,
+                                      search->details->engine_query))
+    {
+        return FALSE;
+    }
+
+    filter = search_filter_new (search->details->query);
+
+    /* A refinement only ever drops types. Checking the type needs the
+     * file info, and hits still to come don't have it yet. */
+    previous_types = caja_query_get_mime_types (search->details->engine_query);
+    types_changed = g_list_length (filter->mime_types) != g_list_length (previous_types);
+    g_list_free_full (previous_types, g_free);
+    if (types_changed)
+    {
+        if (!search->details->search_finished)
+        {
+            search_filter_free (filter);
+            return FALSE;
+        }
+        for (list = search->details->files; list != NULL; list = list->next)
+        {
+            if (!caja_file_check_if_ready (list->data, CAJA_FILE_ATTRIBUTE_INFO))
+            {
+                search_filter_free (filter);
+                return FALSE;
+            }
+        }
+    }
+    else
+    {
+        g_list_free_full (filter->mime_types, g_free);
+        filter->mime_types = NULL;
+    }
+
+    if (!search->details->search_finished &&
+        !caja_search_engine_refine_query (search->details->engine,
+                                          search->details->query))
+    {
+        search_filter_free (filter);
+        return FALSE;
+    }
+
+    kept = NULL;
+    removed = NULL;
+    for (list = search->details->files; list != NULL; list = list->next)
+    {
+        file = list->data;
+
+        if (search_filter_matches (filter, file))
+        {
+            kept = g_list_prepend (kept, file);
+        }
+        else
+        {
+            removed = g_list_prepend (removed, file);
+        }
+    }
+    g_list_free (search->details->files);
+    search->details->files = g_list_reverse (kept);
+
+    if (removed != NULL)
+    {
+        remove_files (search, removed);
+        caja_file_list_free (removed);
+    }
+
+    set_engine_query (search, search->details->query);
+    if (!search->details->search_finished)
+    {
+        search->details->hit_filter = filter;
+    }
+    else
+    {
+        search_filter_free (filter);
+    }
+
+    return TRUE;
+}
+
+static void
+update_search (CajaSearchDirectory *search)
+{
+    if (!refine_search (search))
+    {
+        caja_search_engine_stop (search->details->engine);
+        start_search (search);
+    }
+}
+
+static gboolean
+stop_search_timeout_callback (gpointer callback_data)
+{
+    CajaSearchDirectory *search;
+
+    search = CAJA_SEARCH_DIRECTORY (callback_data);
+    search->details->stop_timeout_id = 0;
+
+    stop_search (search);
+
+    return FALSE;
+}
+
 static void
 start_or_stop_search_engine (CajaSearchDirectory *search, gboolean adding)
 {
     if (adding && (search->details->monitor_list ||
                    search->details->pending_callback_list) &&
-            search->details->query &&
-            !search->details->search_running)
+            search->details->query)
     {
-        /* We need to start the search engine */
-        search->details->search_running = TRUE;
-        search->details->search_finished = FALSE;
-        ensure_search_engine (search);
-        caja_search_engine_set_query (search->details->engine, search->details->query);
-
-        reset_file_list (search);
+        if (search->details->stop_timeout_id != 0)
+        {
+            g_source_remove (search->details->stop_timeout_id);
+            search->details->stop_timeout_id = 0;
+        }
 
-        caja_search_engine_start (search->details->engine);
+        if (!search->details->search_running)
+        {
+            /* We need to start the search engine */
+            start_search (search);
+        }
+        else if (search->details->query != search->details->engine_query)
+        {
+            update_search (search);
+        }
     }
     else if (!adding && !search->details->monitor_list &&
              !search->details->pending_callback_list &&
              search->details->engine &&
-             search->details->search_running)
+             search->details->search_running &&
+             search->details->stop_timeout_id == 0)
     {
-        search->details->search_running = FALSE;
-        caja_search_engine_stop (search->details->engine);
-
-        reset_file_list (search);
+        search->details->stop_timeout_id =
+            g_timeout_add_seconds (SEARCH_STOP_DELAY,
+                                   stop_search_timeout_callback,
+                                   search);
     }
 
 }
@@ -518,6 +807,14 @@ search_engine_hits_added (CajaSearchEngine *engine, GList *hits,
 
         file = caja_file_get_by_uri (uri);
 
+        /* Found before the search was refined */
+        if (search->details->hit_filter != NULL &&
+            !search_filter_matches (search->details->hit_filter, file))
+        {
+            caja_file_unref (file);
+            continue;
+        }
+
         for (monitor_list = search->details->monitor_list; monitor_list; monitor_list = monitor_list->next)
         {
             monitor = monitor_list->data;
@@ -609,6 +906,12 @@ search_engine_finished (CajaSearchEngine *engine, CajaSearchDirectory *search)
 {
     search->details->search_finished = TRUE;
 
+    if (search->details->hit_filter != NULL)
+    {
+        search_filter_free (search->details->hit_filter);
+        search->details->hit_filter = NULL;
+    }
+
     caja_directory_emit_done_loading (CAJA_DIRECTORY (search));
 
     /* Add all file callbacks */
@@ -633,6 +936,15 @@ search_force_reload (CajaDirectory *directory)
         return;
     }
 
+    /* A new query that only narrows the last one down doesn't need
+     * the search to start over. */
+    if (search->details->search_running &&
+        search->details->query != search->details->engine_query &&
+        refine_search (search))
+    {
+        return;
+    }
+
     search->details->search_finished = FALSE;
 
     if (!search->details->engine)
@@ -647,6 +959,7 @@ search_force_reload (CajaDirectory *directory)
     {
         caja_search_engine_stop (search->details->engine);
         caja_search_engine_set_query (search->details->engine, search->details->query);
+        set_engine_query (search, search->details->query);
         caja_search_engine_start (search->details->engine);
     }
 }
@@ -735,6 +1048,14 @@ search_dispose (GObject *object)
         search->details->query = NULL;
     }
 
+    if (search->details->stop_timeout_id != 0)
+    {
+        g_source_remove (search->details->stop_timeout_id);
+        search->details->stop_timeout_id = 0;
+    }
+
+    set_engine_query (search, NULL);
+
     if (search->details->engine)
     {
         if (search->details->search_running)
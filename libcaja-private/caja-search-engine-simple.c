@@ -43,6 +43,14 @@ typedef struct
     GList *tags;
     char **words;
 
+    /* Set from the main thread when the query is refined, picked up
+     * by the search thread before the next directory.
+     */
+    GMutex refine_lock;
+    char **refined_words;
+    GList *refined_mime_types;
+    gboolean refined;
+
     GQueue *directories; /* GFiles */
 
     GHashTable *visited;
@@ -91,7 +99,7 @@ search_thread_data_new (CajaSearchEngineSimple *engine,
                         CajaQuery *query)
 {
     SearchThreadData *data;
-    char *text, *lower, *normalized, *uri;
+    char *uri;
     GFile *location;
 
     data = g_new0 (SearchThreadData, 1);
@@ -112,13 +120,8 @@ search_thread_data_new (CajaSearchEngineSimple *engine,
     }
     g_queue_push_tail (data->directories, location);
 
-    text = caja_query_get_text (query);
-    normalized = g_utf8_normalize (text, -1, G_NORMALIZE_NFD);
-    lower = g_utf8_strdown (normalized, -1);
-    data->words = g_strsplit (lower, " ", -1);
-    g_free (text);
-    g_free (lower);
-    g_free (normalized);
+    data->words = caja_query_get_words (query);
+    g_mutex_init (&data->refine_lock);
 
     data->tags = caja_query_get_tags (query);
     data->mime_types = caja_query_get_mime_types (query);
@@ -139,6 +142,9 @@ search_thread_data_free (SearchThreadData *data)
     g_queue_free (data->directories);
     g_hash_table_destroy (data->visited);
     g_object_unref (data->cancellable);
+    g_mutex_clear (&data->refine_lock);
+    g_strfreev (data->refined_words);
+    g_list_free_full (data->refined_mime_types, g_free);
     g_strfreev (data->words);
     g_list_free_full (data->tags, g_free);
     g_list_free_full (data->mime_types, g_free);
@@ -616,6 +622,25 @@ next:
     g_object_unref (enumerator);
 }
 
+static void
+apply_refined_query (SearchThreadData *data)
+{
+    g_mutex_lock (&data->refine_lock);
+    if (data->refined)
+    {
+        g_strfreev (data->words);
+        data->words = data->refined_words;
+        data->refined_words = NULL;
+
+        g_list_free_full (data->mime_types, g_free);
+        data->mime_types = data->refined_mime_types;
+        data->refined_mime_types = NULL;
+
+        data->refined = FALSE;
+    }
+    g_mutex_unlock (&data->refine_lock);
+}
+
 static gpointer
 search_thread_func (gpointer user_data)
 {
@@ -643,6 +668,7 @@ search_thread_func (gpointer user_data)
     while (!g_cancellable_is_cancelled (data->cancellable) &&
             (dir = g_queue_pop_head (data->directories)) != NULL)
     {
+        apply_refined_query (data);
         visit_directory (dir, data);
         g_object_unref (dir);
     }
@@ -700,6 +726,39 @@ caja_search_engine_simple_is_indexed (CajaSearchEngine *engine)
     return FALSE;
 }
 
+static gboolean
+caja_search_engine_simple_refine_query (CajaSearchEngine *engine,
+                                        CajaQuery *query)
+{
+    CajaSearchEngineSimple *simple;
+    SearchThreadData *data;
+
+    simple = CAJA_SEARCH_ENGINE_SIMPLE (engine);
+    data = simple->details->active_search;
+
+    if (data == NULL || simple->details->query == NULL ||
+        !caja_query_is_refinement_of (query, simple->details->query))
+    {
+        return FALSE;
+    }
+
+    /* Directories already visited keep their hits, the caller filters
+     * those itself. */
+    g_mutex_lock (&data->refine_lock);
+    g_strfreev (data->refined_words);
+    g_list_free_full (data->refined_mime_types, g_free);
+    data->refined_words = caja_query_get_words (query);
+    data->refined_mime_types = caja_query_get_mime_types (query);
+    data->refined = TRUE;
+    g_mutex_unlock (&data->refine_lock);
+
+    g_object_ref (query);
+    g_object_unref (simple->details->query);
+    simple->details->query = query;
+
+    return TRUE;
+}
+
 static void
 caja_search_engine_simple_set_query (CajaSearchEngine *engine, CajaQuery *query)
 {
@@ -736,6 +795,7 @@ caja_search_engine_simple_class_init (CajaSearchEngineSimpleClass *class)
     engine_class->start = caja_search_engine_simple_start;
     engine_class->stop = caja_search_engine_simple_stop;
     engine_class->is_indexed = caja_search_engine_simple_is_indexed;
+    engine_class->refine_query = caja_search_engine_simple_refine_query;
 }
 
 static void
@@ -151,6 +151,24 @@ caja_search_engine_is_indexed (CajaSearchEngine *engine)
     return CAJA_SEARCH_ENGINE_GET_CLASS (engine)->is_indexed (engine);
 }
 
+/* Switch a running search over to a query that is a refinement of its
+ * current one, the rest of the search then only reports hits of the
+ * new query. Returns FALSE if the engine can't, the search has to be
+ * restarted then.
+ */
+gboolean
+caja_search_engine_refine_query (CajaSearchEngine *engine, CajaQuery *query)
+{
+    g_return_val_if_fail (CAJA_IS_SEARCH_ENGINE (engine), FALSE);
+
+    if (CAJA_SEARCH_ENGINE_GET_CLASS (engine)->refine_query == NULL)
+    {
+        return FALSE;
+    }
+
+    return CAJA_SEARCH_ENGINE_GET_CLASS (engine)->refine_query (engine, query);
+}
+
 void
 caja_search_engine_hits_added (CajaSearchEngine *engine, GList *hits)
 {
@@ -49,6 +49,8 @@ typedef struct
     void (*start) (CajaSearchEngine *engine);
     void (*stop) (CajaSearchEngine *engine);
     gboolean (*is_indexed) (CajaSearchEngine *engine);
+    /* Optional, see caja_search_engine_refine_query() */
+    gboolean (*refine_query) (CajaSearchEngine *engine, CajaQuery *query);
 
     /* Signals */
     void (*hits_added) (CajaSearchEngine *engine, GList *hits);
@@ -66,6 +68,7 @@ void           caja_search_engine_set_query (CajaSearchEngine *engine, CajaQuery
 void	       caja_search_engine_start (CajaSearchEngine *engine);
 void	       caja_search_engine_stop (CajaSearchEngine *engine);
 gboolean       caja_search_engine_is_indexed (CajaSearchEngine *engine);
+gboolean       caja_search_engine_refine_query (CajaSearchEngine *engine, CajaQuery *query);
 
 void	       caja_search_engine_hits_added (CajaSearchEngine *engine, GList *hits);
 void	       caja_search_engine_hits_subtracted (CajaSearchEngine *engine, GList *hits);
@@ -42,11 +42,14 @@ enum
     POPUP_MENU_CHANGED,
     USER_DIRS_CHANGED,
     MIME_DATA_CHANGED,
+    DAY_CHANGED,
     LAST_SIGNAL
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+static guint day_changed_id = 0;
+
 static GType caja_signaller_get_type (void);
 
 G_DEFINE_TYPE (CajaSignaller, caja_signaller, G_TYPE_OBJECT);
@@ -65,14 +68,67 @@ caja_signaller_get_current (void)
     return global_signaller;
 }
 
+static void schedule_day_changed (CajaSignaller *signaller);
+
+static gboolean
+day_changed_callback (gpointer user_data)
+{
+    CajaSignaller *signaller;
+
+    signaller = user_data;
+
+    day_changed_id = 0;
+    schedule_day_changed (signaller);
+
+    g_signal_emit (signaller, signals[DAY_CHANGED], 0);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Informal dates ("Yesterday", ...) depend on the current day, so
+ * anything caching them listens to "day_changed", emitted just after
+ * midnight. */
+static void
+schedule_day_changed (CajaSignaller *signaller)
+{
+    GDateTime *now;
+    int seconds_left;
+
+    now = g_date_time_new_now_local ();
+    seconds_left = 24 * 60 * 60 -
+                   (g_date_time_get_hour (now) * 60 * 60 +
+                    g_date_time_get_minute (now) * 60 +
+                    g_date_time_get_second (now));
+    g_date_time_unref (now);
+
+    day_changed_id = g_timeout_add_seconds (seconds_left + 1,
+                                            day_changed_callback,
+                                            signaller);
+}
+
 static void
 caja_signaller_init (CajaSignaller *signaller)
 {
+    schedule_day_changed (signaller);
+}
+
+static void
+caja_signaller_finalize (GObject *object)
+{
+    if (day_changed_id != 0)
+    {
+        g_source_remove (day_changed_id);
+        day_changed_id = 0;
+    }
+
+    G_OBJECT_CLASS (caja_signaller_parent_class)->finalize (object);
 }
 
 static void
 caja_signaller_class_init (CajaSignallerClass *class)
 {
+    G_OBJECT_CLASS (class)->finalize = caja_signaller_finalize;
+
     signals[HISTORY_LIST_CHANGED] =
         g_signal_new ("history_list_changed",
                       G_TYPE_FROM_CLASS (class),
@@ -113,4 +169,12 @@ caja_signaller_class_init (CajaSignallerClass *class)
                       NULL, NULL,
                       g_cclosure_marshal_VOID__VOID,
                       G_TYPE_NONE, 0);
+    signals[DAY_CHANGED] =
+        g_signal_new ("day_changed",
+                      G_TYPE_FROM_CLASS (class),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL, NULL,
+                      g_cclosure_marshal_VOID__VOID,
+                      G_TYPE_NONE, 0);
 }
@@ -92,6 +92,34 @@ vfs_file_check_if_ready (CajaFile *file,
             file_attributes);
 }
 
+/* Milliseconds metadata changes are held back, so that several keys of
+ * a file and changes to many files are written together. */
+#define METADATA_WRITE_DELAY 100
+
+/* Number of files whose metadata is written per main loop iteration */
+#define METADATA_WRITE_BATCH 64
+
+typedef struct
+{
+    CajaFile *file;
+    GFileInfo *info;
+    gboolean changed;
+    gboolean needs_refresh;
+} PendingMetadata;
+
+/* CajaFile -> PendingMetadata, with the queue keeping the order */
+static GHashTable *pending_metadata = NULL;
+static GQueue pending_metadata_queue = G_QUEUE_INIT;
+static guint pending_metadata_id = 0;
+
+static void
+pending_metadata_free (PendingMetadata *pending)
+{
+    caja_file_unref (pending->file);
+    g_object_unref (pending->info);
+    g_free (pending);
+}
+
 static void
 set_metadata_get_info_callback (GObject *source_object,
                                 GAsyncResult *res,
@@ -125,11 +153,11 @@ set_metadata_callback (GObject *source_object,
                        GAsyncResult *result,
                        gpointer callback_data)
 {
-    CajaFile *file;
+    PendingMetadata *pending;
     GError *error;
     gboolean res;
 
-    file = callback_data;
+    pending = callback_data;
 
     error = NULL;
     res = g_file_set_attributes_finish (G_FILE (source_object),
@@ -137,20 +165,102 @@ set_metadata_callback (GObject *source_object,
                                         NULL,
                                         &error);
 
-    if (res)
+    /* The cached metadata already has the new values, unless a key
+     * is not cached or the write failed and they have to be read back. */
+    if (!res || pending->needs_refresh)
     {
         g_file_query_info_async (G_FILE (source_object),
                                  CAJA_FILE_DEFAULT_ATTRIBUTES,
                                  0,
                                  G_PRIORITY_DEFAULT,
                                  NULL,
-                                 set_metadata_get_info_callback, file);
+                                 set_metadata_get_info_callback,
+                                 caja_file_ref (pending->file));
     }
-    else
+
+    if (error != NULL)
     {
-        caja_file_unref (file);
         g_error_free (error);
     }
+    pending_metadata_free (pending);
+}
+
+static void
+write_pending_metadata (guint max_count)
+{
+    PendingMetadata *pending;
+    GFile *location;
+    guint count;
+
+    for (count = 0; count < max_count; count++)
+    {
+        pending = g_queue_pop_head (&pending_metadata_queue);
+        if (pending == NULL)
+        {
+            break;
+        }
+        g_hash_table_remove (pending_metadata, pending->file);
+
+        if (pending->changed)
+        {
+            caja_file_changed (pending->file);
+        }
+
+        location = caja_file_get_location (pending->file);
+        g_file_set_attributes_async (location,
+                                     pending->info,
+                                     0,
+                                     G_PRIORITY_DEFAULT,
+                                     NULL,
+                                     set_metadata_callback,
+                                     pending);
+        g_object_unref (location);
+    }
+}
+
+static gboolean
+write_pending_metadata_callback (gpointer callback_data)
+{
+    pending_metadata_id = 0;
+
+    write_pending_metadata (METADATA_WRITE_BATCH);
+
+    if (!g_queue_is_empty (&pending_metadata_queue))
+    {
+        pending_metadata_id = g_idle_add (write_pending_metadata_callback, NULL);
+    }
+
+    return FALSE;
+}
+
+static PendingMetadata *
+get_pending_metadata (CajaFile *file)
+{
+    PendingMetadata *pending;
+
+    if (pending_metadata == NULL)
+    {
+        pending_metadata = g_hash_table_new (NULL, NULL);
+    }
+
+    pending = g_hash_table_lookup (pending_metadata, file);
+    if (pending == NULL)
+    {
+        pending = g_new0 (PendingMetadata, 1);
+        pending->file = caja_file_ref (file);
+        pending->info = g_file_info_new ();
+        g_hash_table_insert (pending_metadata, file, pending);
+        g_queue_push_tail (&pending_metadata_queue, pending);
+    }
+
+    if (pending_metadata_id == 0)
+    {
+        pending_metadata_id = g_timeout_add (METADATA_WRITE_DELAY,
+                                             write_pending_metadata_callback,
+                                             NULL);
+    }
+
+    return pending;
 }
 
 static void
@@ -158,36 +268,34 @@ vfs_file_set_metadata (CajaFile           *file,
                        const char             *key,
                        const char             *value)
 {
-    GFileInfo *info;
-    GFile *location;
+    PendingMetadata *pending;
     char *gio_key;
+    gboolean known;
 
-    info = g_file_info_new ();
+    pending = get_pending_metadata (file);
 
     gio_key = g_strconcat ("metadata::", key, NULL);
     if (value != NULL)
     {
-        g_file_info_set_attribute_string (info, gio_key, value);
+        g_file_info_set_attribute_string (pending->info, gio_key, value);
     }
     else
     {
         /* Unset the key */
-        g_file_info_set_attribute (info, gio_key,
+        g_file_info_set_attribute (pending->info, gio_key,
                                    G_FILE_ATTRIBUTE_TYPE_INVALID,
                                    NULL);
     }
     g_free (gio_key);
 
-    location = caja_file_get_location (file);
-    g_file_set_attributes_async (location,
-                                 info,
-                                 0,
-                                 G_PRIORITY_DEFAULT,
-                                 NULL,
-                                 set_metadata_callback,
-                                 caja_file_ref (file));
-    g_object_unref (location);
-    g_object_unref (info);
+    if (caja_file_update_metadata (file, key, value, &known))
+    {
+        pending->changed = TRUE;
+    }
+    if (!known)
+    {
+        pending->needs_refresh = TRUE;
+    }
 }
 
 static void
@@ -195,26 +303,52 @@ vfs_file_set_metadata_as_list (CajaFile           *file,
                                const char             *key,
                                char                  **value)
 {
-    GFile *location;
-    GFileInfo *info;
+    PendingMetadata *pending;
     char *gio_key;
+    gboolean known;
 
-    info = g_file_info_new ();
+    pending = get_pending_metadata (file);
 
     gio_key = g_strconcat ("metadata::", key, NULL);
-    g_file_info_set_attribute_stringv (info, gio_key, value);
+    g_file_info_set_attribute_stringv (pending->info, gio_key, value);
     g_free (gio_key);
 
-    location = caja_file_get_location (file);
-    g_file_set_attributes_async (location,
-                                 info,
-                                 0,
-                                 G_PRIORITY_DEFAULT,
-                                 NULL,
-                                 set_metadata_callback,
-                                 caja_file_ref (file));
-    g_object_unref (info);
-    g_object_unref (location);
+    if (caja_file_update_metadata_list (file, key, value, &known))
+    {
+        pending->changed = TRUE;
+    }
+    if (!known)
+    {
+        pending->needs_refresh = TRUE;
+    }
+}
+
+void
+caja_vfs_file_flush_metadata (void)
+{
+    PendingMetadata *pending;
+    GFile *location;
+
+    if (pending_metadata_id != 0)
+    {
+        g_source_remove (pending_metadata_id);
+        pending_metadata_id = 0;
+    }
+
+    while ((pending = g_queue_pop_head (&pending_metadata_queue)) != NULL)
+    {
+        g_hash_table_remove (pending_metadata, pending->file);
+
+        location = caja_file_get_location (pending->file);
+        g_file_set_attributes_from_info (location,
+                                         pending->info,
+                                         0,
+                                         NULL,
+                                         NULL);
+        g_object_unref (location);
+
+        pending_metadata_free (pending);
+    }
 }
 
 static gboolean
@@ -281,23 +415,23 @@ vfs_file_get_deep_counts (CajaFile *file,
     {
         if (directory_count != NULL)
         {
-            *directory_count = file->details->deep_directory_count;
+            *directory_count = CAJA_FILE_COLD (file, deep_directory_count, 0);
         }
         if (file_count != NULL)
         {
-            *file_count = file->details->deep_file_count;
+            *file_count = CAJA_FILE_COLD (file, deep_file_count, 0);
         }
         if (unreadable_directory_count != NULL)
         {
-            *unreadable_directory_count = file->details->deep_unreadable_count;
+            *unreadable_directory_count = CAJA_FILE_COLD (file, deep_unreadable_count, 0);
         }
         if (total_size != NULL)
         {
-            *total_size = file->details->deep_size;
+            *total_size = CAJA_FILE_COLD (file, deep_size, 0);
         }
         if (total_size_on_disk != NULL)
         {
-            *total_size_on_disk = file->details->deep_size_on_disk;
+            *total_size_on_disk = CAJA_FILE_COLD (file, deep_size_on_disk, 0);
         }
         return file->details->deep_counts_status;
     }
@@ -367,13 +501,13 @@ vfs_file_get_date (CajaFile *file,
         return TRUE;
     case CAJA_DATE_TYPE_TRASHED:
         /* Before we have info on a file, the date is unknown. */
-        if (file->details->trash_time == 0)
+        if (CAJA_FILE_COLD (file, trash_time, 0) == 0)
         {
             return FALSE;
         }
         if (date != NULL)
         {
-            *date = file->details->trash_time;
+            *date = file->details->cold->trash_time;
         }
         return TRUE;
     case CAJA_DATE_TYPE_PERMISSIONS_CHANGED:
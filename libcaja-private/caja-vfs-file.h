@@ -54,4 +54,8 @@ typedef struct
 
 GType   caja_vfs_file_get_type (void);
 
+/* Metadata is written back in batches, this writes out what is still
+ * pending right away. Meant to be called on exit. */
+void    caja_vfs_file_flush_metadata (void);
+
 #endif /* CAJA_VFS_FILE_H */
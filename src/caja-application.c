@@ -50,6 +50,7 @@
 #include <eel/eel-stock-dialogs.h>
 
 #include <libcaja-private/caja-debug-log.h>
+#include <libcaja-private/caja-desktop-metadata.h>
 #include <libcaja-private/caja-file-utilities.h>
 #include <libcaja-private/caja-global-preferences.h>
 #include <libcaja-private/caja-lib-self-check-functions.h>
@@ -58,6 +59,7 @@
 #include <libcaja-private/caja-desktop-link-monitor.h>
 #include <libcaja-private/caja-directory-private.h>
 #include <libcaja-private/caja-signaller.h>
+#include <libcaja-private/caja-vfs-file.h>
 #include <libcaja-extension/caja-menu-provider.h>
 #include <libcaja-private/caja-autorun.h>
 
@@ -463,6 +465,8 @@ caja_application_finalize (GObject *object)
     application = CAJA_APPLICATION (object);
 
     caja_bookmarks_exiting ();
+    caja_vfs_file_flush_metadata ();
+    caja_desktop_metadata_flush ();
 
    if (application->volume_monitor)
     {
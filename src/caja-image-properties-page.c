@@ -39,34 +39,44 @@
 #include <exempi/xmpconsts.h>
 #endif /*HAVE_EXEMPI*/
 
+#include <eel/eel-debug.h>
 #include <eel/eel-vfs-extensions.h>
 
 #include <libcaja-extension/caja-property-page-provider.h>
+#include <libcaja-private/caja-file.h>
 #include <libcaja-private/caja-module.h>
 
 #include "caja-image-properties-page.h"
 
 #define LOAD_BUFFER_SIZE 8192
 
+/* Number of images whose information is kept */
+#define METADATA_CACHE_SIZE 64
+
+/* What the page shows about an image, extracted in a thread and kept
+ * for as long as the file has the same modification time and size.
+ */
+typedef struct
+{
+    char *uri;
+    time_t mtime;
+    goffset size;
+
+    gboolean got_size;
+    int width;
+    int height;
+    char *format;
+    GPtrArray *rows; /* descriptions and values, in turn */
+} ImageMetadata;
+
 struct _CajaImagePropertiesPagePrivate
 {
     GCancellable *cancellable;
+    gboolean cancel_on_dispose;
     GtkWidget *vbox;
     GtkWidget *loading_label;
     GtkWidget *grid;
-    GdkPixbufLoader *loader;
-    gboolean got_size;
-    gboolean pixbuf_still_loading;
-    char buffer[LOAD_BUFFER_SIZE];
-    int width;
-    int height;
     int row;
-#ifdef HAVE_EXIF
-    ExifLoader *exifldr;
-#endif /*HAVE_EXIF*/
-#ifdef HAVE_EXEMPI
-    XmpPtr     xmp;
-#endif /*HAVE_EXEMPI*/
 };
 
 #ifdef HAVE_EXIF
@@ -78,6 +88,12 @@ struct ExifAttribute
 };
 #endif /*HAVE_EXIF*/
 
+typedef struct
+{
+    ImageMetadata *metadata;
+    gboolean pixbuf_still_loading;
+} ExtractState;
+
 enum
 {
     PROP_URI
@@ -102,38 +118,123 @@ G_DEFINE_TYPE_WITH_CODE (CajaImagePropertiesPageProvider, caja_image_properties_
                          G_IMPLEMENT_INTERFACE (CAJA_TYPE_PROPERTY_PAGE_PROVIDER,
                                  property_page_provider_iface_init));
 
+static GHashTable *metadata_cache = NULL;
+static GQueue metadata_cache_lru = G_QUEUE_INIT; /* most recently used first */
+
+#ifdef HAVE_EXEMPI
+/* Exempi is not known to be safe to use from several threads at once */
+static GMutex xmp_mutex;
+#endif /*HAVE_EXEMPI*/
+
 static void
-caja_image_properties_page_finalize (GObject *object)
+caja_image_properties_page_dispose (GObject *object)
 {
     CajaImagePropertiesPage *page;
 
     page = CAJA_IMAGE_PROPERTIES_PAGE (object);
 
+    /* A local extraction is let finish so its result still makes it
+     * into the cache, the task holds its own references. Reading a
+     * remote image can take long, that one is stopped. */
     if (page->details->cancellable)
     {
-        g_cancellable_cancel (page->details->cancellable);
+        if (page->details->cancel_on_dispose)
+        {
+            g_cancellable_cancel (page->details->cancellable);
+        }
         g_object_unref (page->details->cancellable);
         page->details->cancellable = NULL;
     }
 
-    G_OBJECT_CLASS (caja_image_properties_page_parent_class)->finalize (object);
+    G_OBJECT_CLASS (caja_image_properties_page_parent_class)->dispose (object);
+}
+
+static ImageMetadata *
+image_metadata_new (const char *uri,
+                    time_t      mtime,
+                    goffset     size)
+{
+    ImageMetadata *metadata;
+
+    metadata = g_new0 (ImageMetadata, 1);
+    metadata->uri = g_strdup (uri);
+    metadata->mtime = mtime;
+    metadata->size = size;
+    metadata->rows = g_ptr_array_new_with_free_func (g_free);
+
+    return metadata;
 }
 
 static void
-file_close_callback (GObject      *object,
-                     GAsyncResult *res,
-                     gpointer      data)
+image_metadata_free (ImageMetadata *metadata)
 {
-    CajaImagePropertiesPage *page;
-    GInputStream *stream;
+    g_free (metadata->uri);
+    g_free (metadata->format);
+    g_ptr_array_unref (metadata->rows);
+    g_free (metadata);
+}
 
-    page = CAJA_IMAGE_PROPERTIES_PAGE (data);
-    stream = G_INPUT_STREAM (object);
+static ImageMetadata *
+metadata_cache_lookup (const char *uri,
+                       time_t      mtime,
+                       goffset     size)
+{
+    ImageMetadata *metadata;
 
-    g_input_stream_close_finish (stream, res, NULL);
+    if (metadata_cache == NULL)
+    {
+        return NULL;
+    }
+
+    metadata = g_hash_table_lookup (metadata_cache, uri);
+    if (metadata == NULL ||
+        metadata->mtime != mtime ||
+        metadata->size != size)
+    {
+        return NULL;
+    }
 
-    g_object_unref (page->details->cancellable);
-    page->details->cancellable = NULL;
+    g_queue_remove (&metadata_cache_lru, metadata);
+    g_queue_push_head (&metadata_cache_lru, metadata);
+
+    return metadata;
+}
+
+static void
+metadata_cache_free (void)
+{
+    g_queue_clear (&metadata_cache_lru);
+    g_clear_pointer (&metadata_cache, g_hash_table_destroy);
+}
+
+static void
+metadata_cache_add (ImageMetadata *metadata)
+{
+    ImageMetadata *old;
+
+    if (metadata_cache == NULL)
+    {
+        metadata_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                NULL,
+                                                (GDestroyNotify) image_metadata_free);
+        eel_debug_call_at_shutdown (metadata_cache_free);
+    }
+
+    old = g_hash_table_lookup (metadata_cache, metadata->uri);
+    if (old != NULL)
+    {
+        g_queue_remove (&metadata_cache_lru, old);
+        g_hash_table_remove (metadata_cache, old->uri);
+    }
+
+    g_hash_table_insert (metadata_cache, metadata->uri, metadata);
+    g_queue_push_head (&metadata_cache_lru, metadata);
+
+    while (g_queue_get_length (&metadata_cache_lru) > METADATA_CACHE_SIZE)
+    {
+        old = g_queue_pop_tail (&metadata_cache_lru);
+        g_hash_table_remove (metadata_cache, old->uri);
+    }
 }
 
 static GtkWidget *
@@ -188,6 +289,15 @@ add_row (CajaImagePropertiesPage *page,
     page->details->row++;
 }
 
+static void
+append_row (ImageMetadata *metadata,
+            const char    *description,
+            const char    *value)
+{
+    g_ptr_array_add (metadata->rows, g_strdup (description));
+    g_ptr_array_add (metadata->rows, g_strdup (value));
+}
+
 #ifdef HAVE_EXIF
 static char *
 exif_string_to_utf8 (const char *exif_str)
@@ -259,7 +369,7 @@ exifdata_get_tag_value_utf8 (ExifData *data, ExifTag tag)
 }
 
 static gboolean
-append_tag_value_pair (CajaImagePropertiesPage *page,
+append_tag_value_pair (ImageMetadata *metadata,
                        ExifData *data,
                        ExifTag   tag,
                        char     *description)
@@ -277,7 +387,7 @@ append_tag_value_pair (CajaImagePropertiesPage *page,
         return FALSE;
     }
 
-    add_row (page, description ? description : utf_attribute, utf_value);
+    append_row (metadata, description ? description : utf_attribute, utf_value);
 
     g_free (utf_attribute);
     g_free (utf_value);
@@ -285,37 +395,37 @@ append_tag_value_pair (CajaImagePropertiesPage *page,
 }
 
 static void
-append_exifdata_string (ExifData *exifdata, CajaImagePropertiesPage *page)
+append_exifdata_string (ExifData *exifdata, ImageMetadata *metadata)
 {
     if (exifdata && exifdata->ifd[0] && exifdata->ifd[0]->count)
     {
-        append_tag_value_pair (page, exifdata, EXIF_TAG_MAKE, _("Camera Brand"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_MODEL, _("Camera Model"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_MAKE, _("Camera Brand"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_MODEL, _("Camera Model"));
 
         /* Choose which date to show in order of relevance */
-        if (!append_tag_value_pair (page, exifdata, EXIF_TAG_DATE_TIME_ORIGINAL, _("Date Taken")))
+        if (!append_tag_value_pair (metadata, exifdata, EXIF_TAG_DATE_TIME_ORIGINAL, _("Date Taken")))
         {
-            if (!append_tag_value_pair (page, exifdata, EXIF_TAG_DATE_TIME_DIGITIZED, _("Date Digitized")))
+            if (!append_tag_value_pair (metadata, exifdata, EXIF_TAG_DATE_TIME_DIGITIZED, _("Date Digitized")))
             {
-                append_tag_value_pair (page, exifdata, EXIF_TAG_DATE_TIME, _("Date Modified"));
+                append_tag_value_pair (metadata, exifdata, EXIF_TAG_DATE_TIME, _("Date Modified"));
             }
         }
 
-        append_tag_value_pair (page, exifdata, EXIF_TAG_EXPOSURE_TIME, _("Exposure Time"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_APERTURE_VALUE, _("Aperture Value"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_ISO_SPEED_RATINGS, _("ISO Speed Rating"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_FLASH,_("Flash Fired"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_METERING_MODE, _("Metering Mode"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_EXPOSURE_PROGRAM, _("Exposure Program"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_FOCAL_LENGTH,_("Focal Length"));
-        append_tag_value_pair (page, exifdata, EXIF_TAG_SOFTWARE, _("Software"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_EXPOSURE_TIME, _("Exposure Time"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_APERTURE_VALUE, _("Aperture Value"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_ISO_SPEED_RATINGS, _("ISO Speed Rating"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_FLASH,_("Flash Fired"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_METERING_MODE, _("Metering Mode"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_EXPOSURE_PROGRAM, _("Exposure Program"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_FOCAL_LENGTH,_("Focal Length"));
+        append_tag_value_pair (metadata, exifdata, EXIF_TAG_SOFTWARE, _("Software"));
     }
 }
 #endif /*HAVE_EXIF*/
 
 #ifdef HAVE_EXEMPI
 static void
-append_xmp_value_pair (CajaImagePropertiesPage *page,
+append_xmp_value_pair (ImageMetadata *metadata,
                        XmpPtr      xmp,
                        const char *ns,
                        const char *propname,
@@ -330,7 +440,7 @@ append_xmp_value_pair (CajaImagePropertiesPage *page,
     {
         if (XMP_IS_PROP_SIMPLE (options))
         {
-            add_row (page, descr, xmp_string_cstr (value));
+            append_row (metadata, descr, xmp_string_cstr (value));
         }
         else if (XMP_IS_PROP_ARRAY (options))
         {
@@ -362,7 +472,7 @@ append_xmp_value_pair (CajaImagePropertiesPage *page,
                 }
                 xmp_iterator_free(iter);
                 value_str = g_string_free (str, FALSE);
-                add_row (page, descr, value_str);
+                append_row (metadata, descr, value_str);
                 g_free (value_str);
             }
         }
@@ -371,278 +481,304 @@ append_xmp_value_pair (CajaImagePropertiesPage *page,
 }
 
 static void
-append_xmpdata_string (XmpPtr xmp, CajaImagePropertiesPage *page)
+append_xmpdata_string (XmpPtr xmp, ImageMetadata *metadata)
 {
     if (xmp != NULL)
     {
-        append_xmp_value_pair (page, xmp, NS_IPTC4XMP, "Location", _("Location"));
-        append_xmp_value_pair (page, xmp, NS_DC, "description", _("Description"));
-        append_xmp_value_pair (page, xmp, NS_DC, "subject", _("Keywords"));
-        append_xmp_value_pair (page, xmp, NS_DC, "creator", _("Creator"));
-        append_xmp_value_pair (page, xmp, NS_DC, "rights", _("Copyright"));
-        append_xmp_value_pair (page, xmp, NS_XAP,"Rating", _("Rating"));
+        append_xmp_value_pair (metadata, xmp, NS_IPTC4XMP, "Location", _("Location"));
+        append_xmp_value_pair (metadata, xmp, NS_DC, "description", _("Description"));
+        append_xmp_value_pair (metadata, xmp, NS_DC, "subject", _("Keywords"));
+        append_xmp_value_pair (metadata, xmp, NS_DC, "creator", _("Creator"));
+        append_xmp_value_pair (metadata, xmp, NS_DC, "rights", _("Copyright"));
+        append_xmp_value_pair (metadata, xmp, NS_XAP,"Rating", _("Rating"));
         /* TODO add CC licenses */
     }
 }
 #endif /*HAVE EXEMPI*/
 
 static void
-load_finished (CajaImagePropertiesPage *page)
+size_prepared_callback (GdkPixbufLoader *loader,
+                        int              width,
+                        int              height,
+                        gpointer         callback_data)
 {
-    gtk_widget_destroy (page->details->loading_label);
+    ExtractState *state;
+
+    state = callback_data;
+
+    state->metadata->height = height;
+    state->metadata->width = width;
+    state->metadata->got_size = TRUE;
+    state->pixbuf_still_loading = FALSE;
+}
+
+/* Only reads as much of the file as it takes to know the size and to
+ * get past the EXIF data, which are near the start for most formats.
+ */
+static void
+extract_metadata_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+    ImageMetadata *metadata;
+    ExtractState state;
+    GFile *file;
+    GFileInputStream *stream;
+    GdkPixbufLoader *loader;
+    char *buffer;
+    gssize count_read;
+    int exif_still_loading;
+#ifdef HAVE_EXIF
+    ExifLoader *exifldr;
+#endif /*HAVE_EXIF*/
+
+    metadata = task_data;
+
+    file = g_file_new_for_uri (metadata->uri);
+    stream = g_file_read (file, cancellable, NULL);
+    g_object_unref (file);
+
+    if (stream == NULL)
+    {
+        if (g_cancellable_is_cancelled (cancellable))
+        {
+            g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                     "Cancelled");
+        }
+        else
+        {
+            g_task_return_boolean (task, TRUE);
+        }
+        return;
+    }
+
+    state.metadata = metadata;
+    state.pixbuf_still_loading = TRUE;
+
+    loader = gdk_pixbuf_loader_new ();
+    g_signal_connect (loader, "size_prepared",
+                      G_CALLBACK (size_prepared_callback), &state);
+#ifdef HAVE_EXIF
+    exifldr = exif_loader_new ();
+#endif /*HAVE_EXIF*/
+
+    buffer = g_malloc (LOAD_BUFFER_SIZE);
+    while ((count_read = g_input_stream_read (G_INPUT_STREAM (stream),
+                                              buffer,
+                                              LOAD_BUFFER_SIZE,
+                                              cancellable,
+                                              NULL)) > 0)
+    {
+#ifdef HAVE_EXIF
+        exif_still_loading = exif_loader_write (exifldr,
+                                                (unsigned char *) buffer,
+                                                count_read);
+#else
+        exif_still_loading = 0;
+#endif /*HAVE_EXIF*/
+
+        if (state.pixbuf_still_loading)
+        {
+            if (!gdk_pixbuf_loader_write (loader,
+                                          (const guchar *) buffer,
+                                          count_read,
+                                          NULL))
+            {
+                state.pixbuf_still_loading = FALSE;
+            }
+        }
 
-    if (page->details->loader != NULL) {
-        gdk_pixbuf_loader_close (page->details->loader, NULL);
+        if (!state.pixbuf_still_loading && exif_still_loading != 1)
+        {
+            break;
+        }
     }
+    g_free (buffer);
+
+    g_input_stream_close (G_INPUT_STREAM (stream), NULL, NULL);
+    g_object_unref (stream);
 
-    if (page->details->got_size)
+    gdk_pixbuf_loader_close (loader, NULL);
+
+    if (metadata->got_size)
     {
         GdkPixbufFormat *format;
         g_autofree char *name = NULL;
         g_autofree char *desc = NULL;
-        g_autofree char *value = NULL;
 #ifdef HAVE_EXIF
         ExifData *exif_data;
 #endif /*HAVE_EXIF*/
 
-        format = gdk_pixbuf_loader_get_format (page->details->loader);
+        format = gdk_pixbuf_loader_get_format (loader);
         name = gdk_pixbuf_format_get_name (format);
         desc = gdk_pixbuf_format_get_description (format);
-
-        page->details->grid = gtk_grid_new ();
-        gtk_grid_set_column_spacing (GTK_GRID (page->details->grid), 12);
-        gtk_grid_set_row_spacing (GTK_GRID (page->details->grid), 6);
-        gtk_container_set_border_width (GTK_CONTAINER (page->details->grid), 12);
-        gtk_box_pack_start (GTK_BOX (page->details->vbox), page->details->grid, TRUE, TRUE, 0);
-        page->details->row = 0;
-
-        value = g_strdup_printf ("%s (%s)",name, desc);
-        add_row (page, _("Image Type"), value);
-
-        value = g_strdup_printf (ngettext ("%d pixel",
-                                           "%d pixels",
-                                           page->details->width),
-                                 page->details->width);
-        add_row (page, _("Width"), value);
-
-        value = g_strdup_printf (ngettext ("%d pixel",
-                                           "%d pixels",
-                                           page->details->height),
-                                 page->details->height);
-        add_row (page, _("Height"), value);
+        metadata->format = g_strdup_printf ("%s (%s)", name, desc);
 
 #ifdef HAVE_EXIF
-        exif_data = exif_loader_get_data (page->details->exifldr);
-        append_exifdata_string (exif_data, page);
+        exif_data = exif_loader_get_data (exifldr);
+        append_exifdata_string (exif_data, metadata);
         exif_data_unref (exif_data);
 #endif /*HAVE_EXIF*/
 #ifdef HAVE_EXEMPI
-        append_xmpdata_string (page->details->xmp, page);
+        {
+            /* Current Exempi does not support setting custom IO to be able to use Mate-vfs */
+            /* So it will only work with local files. Future version might remove this limitation */
+            XmpFilePtr xf;
+            XmpPtr xmp;
+            char *localname;
+
+            localname = g_filename_from_uri (metadata->uri, NULL, NULL);
+            if (localname)
+            {
+                g_mutex_lock (&xmp_mutex);
+                xf = xmp_files_open_new (localname, 0);
+                xmp = xmp_files_get_new_xmp (xf); /* only load when loading */
+                xmp_files_close (xf, 0);
+                append_xmpdata_string (xmp, metadata);
+                if (xmp != NULL)
+                {
+                    xmp_free (xmp);
+                }
+                g_mutex_unlock (&xmp_mutex);
+                g_free (localname);
+            }
+        }
 #endif /*HAVE_EXEMPI*/
-        gtk_widget_show_all (page->details->grid);
-    }
-    else
-    {
-        append_label (page->details->vbox,
-                      _("Failed to load image information"));
     }
 
-    if (page->details->loader != NULL)
-    {
-        g_object_unref (page->details->loader);
-        page->details->loader = NULL;
-    }
+    g_object_unref (loader);
 #ifdef HAVE_EXIF
-    if (page->details->exifldr != NULL)
-    {
-        exif_loader_unref (page->details->exifldr);
-        page->details->exifldr = NULL;
-    }
+    exif_loader_unref (exifldr);
 #endif /*HAVE_EXIF*/
-#ifdef HAVE_EXEMPI
-    if (page->details->xmp != NULL)
+
+    /* A read cut short by cancelling is not worth keeping */
+    if (g_cancellable_is_cancelled (cancellable))
     {
-        xmp_free(page->details->xmp);
-        page->details->xmp = NULL;
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                 "Cancelled");
+        return;
     }
-#endif /*HAVE_EXEMPI*/
+
+    g_task_return_boolean (task, TRUE);
 }
 
 static void
-file_read_callback (GObject      *object,
-                    GAsyncResult *res,
-                    gpointer      data)
+show_metadata (CajaImagePropertiesPage *page,
+               ImageMetadata           *metadata)
 {
-    CajaImagePropertiesPage *page;
-    GInputStream *stream;
-    gssize count_read;
-    GError *error;
-    gboolean done_reading;
+    gtk_widget_destroy (page->details->loading_label);
+    page->details->loading_label = NULL;
 
-    page = CAJA_IMAGE_PROPERTIES_PAGE (data);
-    stream = G_INPUT_STREAM (object);
+    if (metadata->got_size)
+    {
+        g_autofree char *value = NULL;
+        guint i;
 
-    error = NULL;
-    done_reading = FALSE;
-    count_read = g_input_stream_read_finish (stream, res, &error);
+        page->details->grid = gtk_grid_new ();
+        gtk_grid_set_column_spacing (GTK_GRID (page->details->grid), 12);
+        gtk_grid_set_row_spacing (GTK_GRID (page->details->grid), 6);
+        gtk_container_set_border_width (GTK_CONTAINER (page->details->grid), 12);
+        gtk_box_pack_start (GTK_BOX (page->details->vbox), page->details->grid, TRUE, TRUE, 0);
+        page->details->row = 0;
 
-    if (count_read > 0)
-    {
-        int exif_still_loading;
+        add_row (page, _("Image Type"), metadata->format);
 
-        g_assert (((size_t) count_read) <= sizeof (page->details->buffer));
+        value = g_strdup_printf (ngettext ("%d pixel",
+                                           "%d pixels",
+                                           metadata->width),
+                                 metadata->width);
+        add_row (page, _("Width"), value);
 
-#ifdef HAVE_EXIF
-        exif_still_loading = exif_loader_write (page->details->exifldr,
-                                                page->details->buffer,
-                                                count_read);
-#else
-        exif_still_loading = 0;
-#endif /*HAVE_EXIF*/
+        g_free (value);
+        value = g_strdup_printf (ngettext ("%d pixel",
+                                           "%d pixels",
+                                           metadata->height),
+                                 metadata->height);
+        add_row (page, _("Height"), value);
 
-        if (page->details->pixbuf_still_loading)
+        for (i = 0; i + 1 < metadata->rows->len; i += 2)
         {
-            if (!gdk_pixbuf_loader_write (page->details->loader,
-                                          page->details->buffer,
-                                          count_read,
-                                          NULL))
-            {
-                page->details->pixbuf_still_loading = FALSE;
-            }
+            add_row (page,
+                     g_ptr_array_index (metadata->rows, i),
+                     g_ptr_array_index (metadata->rows, i + 1));
         }
 
-        if (page->details->pixbuf_still_loading ||
-                (exif_still_loading == 1))
-        {
-            g_input_stream_read_async (G_INPUT_STREAM (stream),
-                                       page->details->buffer,
-                                       sizeof (page->details->buffer),
-                                       0,
-                                       page->details->cancellable,
-                                       file_read_callback,
-                                       page);
-        }
-        else
-        {
-            done_reading = TRUE;
-        }
+        gtk_widget_show_all (page->details->grid);
     }
     else
     {
-        /* either EOF, cancelled or an error occurred */
-        done_reading = TRUE;
-    }
-
-    if (done_reading)
-    {
-        load_finished (page);
-        g_input_stream_close_async (stream,
-                                    0,
-                                    page->details->cancellable,
-                                    file_close_callback,
-                                    page);
+        append_label (page->details->vbox,
+                      _("Failed to load image information"));
     }
 }
 
 static void
-size_prepared_callback (GdkPixbufLoader *loader,
-                        int              width,
-                        int              height,
-                        gpointer         callback_data)
+extract_metadata_callback (GObject      *source_object,
+                           GAsyncResult *res,
+                           gpointer      user_data)
 {
     CajaImagePropertiesPage *page;
+    ImageMetadata *metadata;
+    GTask *task;
 
-    page = CAJA_IMAGE_PROPERTIES_PAGE (callback_data);
-
-    page->details->height = height;
-    page->details->width = width;
-    page->details->got_size = TRUE;
-    page->details->pixbuf_still_loading = FALSE;
-}
+    page = CAJA_IMAGE_PROPERTIES_PAGE (source_object);
+    task = G_TASK (res);
+    metadata = g_task_get_task_data (task);
 
-static void
-file_open_callback (GObject      *object,
-                    GAsyncResult *res,
-                    gpointer      data)
-{
-    CajaImagePropertiesPage *page;
-    GFile *file;
-    GFileInputStream *stream;
-    GError *error;
-
-    page = CAJA_IMAGE_PROPERTIES_PAGE (data);
-    file = G_FILE (object);
-
-    error = NULL;
-    stream = g_file_read_finish (file, res, &error);
-    if (stream)
+    if (!g_task_propagate_boolean (task, NULL))
     {
-        page->details->loader = gdk_pixbuf_loader_new ();
-        page->details->pixbuf_still_loading = TRUE;
-        page->details->width = 0;
-        page->details->height = 0;
-#ifdef HAVE_EXIF
-        page->details->exifldr = exif_loader_new ();
-#endif /*HAVE_EXIF*/
-
-        g_signal_connect (page->details->loader,
-                          "size_prepared",
-                          G_CALLBACK (size_prepared_callback),
-                          page);
+        image_metadata_free (metadata);
+        return;
+    }
 
-        g_input_stream_read_async (G_INPUT_STREAM (stream),
-                                   page->details->buffer,
-                                   sizeof (page->details->buffer),
-                                   0,
-                                   page->details->cancellable,
-                                   file_read_callback,
-                                   page);
+    /* Keep the result even if the page went away in the meantime, it
+     * is likely to be shown again. */
+    metadata_cache_add (metadata);
 
-        g_object_unref (stream);
+    if (page->details->cancellable != NULL)
+    {
+        show_metadata (page, metadata);
     }
 }
 
 static void
 load_location (CajaImagePropertiesPage *page,
-               const char                  *location)
+               CajaFile                *file)
 {
-    GFile *file;
+    ImageMetadata *metadata;
+    GTask *task;
+    char *uri;
+    time_t mtime;
+    goffset size;
 
     g_assert (CAJA_IS_IMAGE_PROPERTIES_PAGE (page));
-    g_assert (location != NULL);
+    g_assert (CAJA_IS_FILE (file));
 
-    page->details->cancellable = g_cancellable_new ();
-    file = g_file_new_for_uri (location);
+    uri = caja_file_get_uri (file);
+    mtime = caja_file_get_mtime (file);
+    size = caja_file_get_size (file);
 
-#ifdef HAVE_EXEMPI
+    metadata = metadata_cache_lookup (uri, mtime, size);
+    if (metadata != NULL)
     {
-        /* Current Exempi does not support setting custom IO to be able to use Mate-vfs */
-        /* So it will only work with local files. Future version might remove this limitation */
-        XmpFilePtr xf;
-        char *localname;
-
-        localname = g_filename_from_uri (location, NULL, NULL);
-        if (localname)
-        {
-            xf = xmp_files_open_new (localname, 0);
-            page->details->xmp = xmp_files_get_new_xmp (xf); /* only load when loading */
-            xmp_files_close (xf, 0);
-            g_free (localname);
-        }
-        else
-        {
-            page->details->xmp = NULL;
-        }
+        show_metadata (page, metadata);
+        g_free (uri);
+        return;
     }
-#endif /*HAVE_EXEMPI*/
 
-    g_file_read_async (file,
-                       0,
-                       page->details->cancellable,
-                       file_open_callback,
-                       page);
+    page->details->cancellable = g_cancellable_new ();
+    page->details->cancel_on_dispose = !caja_file_is_local (file);
 
-    g_object_unref (file);
+    metadata = image_metadata_new (uri, mtime, size);
+    g_free (uri);
+
+    task = g_task_new (page, page->details->cancellable,
+                       extract_metadata_callback, NULL);
+    g_task_set_task_data (task, metadata, NULL);
+    g_task_set_check_cancellable (task, FALSE);
+    g_task_run_in_thread (task, extract_metadata_thread);
+    g_object_unref (task);
 }
 
 static void
@@ -652,7 +788,7 @@ caja_image_properties_page_class_init (CajaImagePropertiesPageClass *class)
 
     object_class = G_OBJECT_CLASS (class);
 
-    object_class->finalize = caja_image_properties_page_finalize;
+    object_class->dispose = caja_image_properties_page_dispose;
 }
 
 static void
@@ -714,7 +850,6 @@ get_property_pages (CajaPropertyPageProvider *provider,
     CajaPropertyPage *real_page;
     CajaFileInfo *file_info;
     g_autofree char *mime_type = NULL;
-    g_autofree char *uri = NULL;
     CajaImagePropertiesPage *page;
 
     /* Only show the property page if 1 file is selected */
@@ -732,10 +867,8 @@ get_property_pages (CajaPropertyPageProvider *provider,
 
     pages = NULL;
 
-    uri = caja_file_info_get_uri (file_info);
-
     page = g_object_new (caja_image_properties_page_get_type (), NULL);
-    load_location (page, uri);
+    load_location (page, CAJA_FILE (file_info));
 
     real_page = caja_property_page_new
                 ("CajaImagePropertiesPage::property_page",
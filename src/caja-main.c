@@ -47,22 +47,76 @@
 #include <exempi/xmp.h>
 #endif
 
+#include <eel/eel-canvas.h>
 #include <eel/eel-debug.h>
 #include <eel/eel-glib-extensions.h>
 #include <eel/eel-self-checks.h>
 
 #include <libcaja-private/caja-debug-log.h>
+#include <libcaja-private/caja-directory-prefetch.h>
+#include <libcaja-private/caja-file.h>
 #include <libcaja-private/caja-global-preferences.h>
 #include <libcaja-private/caja-icon-names.h>
+#include <libcaja-private/caja-monitor.h>
 
 #include <libegg/eggdesktopfile.h>
 
 #include "caja-window.h"
 
+static void log_cache_statistics (void)
+{
+    guint hits, misses, prefetched, file_count, cold_count;
+    gsize files_size, files_size_inline;
+    guint passes, redraw_requests, damage_rectangles;
+    gint64 total_time, max_time;
+
+    caja_file_get_string_attribute_cache_stats (&hits, &misses);
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "string attribute cache: %u hits, %u misses (%.1f%% hit rate)",
+                    hits, misses,
+                    hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+
+    caja_directory_prefetch_get_statistics (&hits, &misses, &prefetched);
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "directory prefetch: %u directories prefetched, %u hits, %u misses (%.1f%% hit rate)",
+                    prefetched, hits, misses,
+                    hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "file monitors: %u events absorbed",
+                    caja_monitor_get_absorbed_events ());
+
+    caja_file_get_memory_statistics (&file_count, &files_size,
+                                     &files_size_inline, &cold_count);
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "file objects: %u using %" G_GSIZE_FORMAT " bytes, "
+                    "%" G_GSIZE_FORMAT " bytes each on average, %u with cold details",
+                    file_count, files_size,
+                    file_count > 0 ? files_size / file_count : 0,
+                    cold_count);
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "file objects with inline cold details: %" G_GSIZE_FORMAT " bytes, "
+                    "%" G_GSIZE_FORMAT " bytes each on average",
+                    files_size_inline,
+                    file_count > 0 ? files_size_inline / file_count : 0);
+
+    eel_canvas_get_update_statistics (&passes, &total_time, &max_time,
+                                      &redraw_requests, &damage_rectangles);
+    caja_debug_log (TRUE, CAJA_DEBUG_LOG_DOMAIN_USER,
+                    "canvas updates: %u passes, %.2f ms average, %.2f ms max, "
+                    "%u redraw requests merged into %u rectangles",
+                    passes,
+                    passes > 0 ? total_time / 1000.0 / passes : 0.0,
+                    max_time / 1000.0,
+                    redraw_requests, damage_rectangles);
+}
+
 static void dump_debug_log (void)
 {
     char *filename;
 
+    log_cache_statistics ();
+
     filename = g_build_filename (g_get_home_dir (), "caja-debug-log.txt", NULL);
     caja_debug_log_dump (filename, NULL); /* NULL GError */
     g_free (filename);
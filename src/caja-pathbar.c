@@ -25,6 +25,7 @@
 #include <glib/gi18n.h>
 #include <gio/gio.h>
 
+#include <libcaja-private/caja-directory-prefetch.h>
 #include <libcaja-private/caja-file.h>
 #include <libcaja-private/caja-file-utilities.h>
 #include <libcaja-private/caja-global-preferences.h>
@@ -57,6 +58,8 @@ typedef enum
 #define SCROLL_TIMEOUT           150
 #define INITIAL_SCROLL_TIMEOUT   300
 
+#define PATH_BAR_PREFETCH_ANCESTORS 2
+
 static guint path_bar_signals [LAST_SIGNAL] = { 0 };
 
 static gboolean desktop_is_home;
@@ -2108,6 +2111,30 @@ caja_path_bar_update_path (CajaPathBar *path_bar,
     return result;
 }
 
+/* Going up is the most likely next step, so get the nearest ancestors
+ * loaded while the user looks at the current folder. */
+static void
+prefetch_ancestors (GFile *file_path)
+{
+    GFile *ancestor, *parent;
+    int i;
+
+    ancestor = g_file_get_parent (file_path);
+    for (i = 0; ancestor != NULL && i < PATH_BAR_PREFETCH_ANCESTORS; i++)
+    {
+        caja_directory_prefetch_add (ancestor);
+
+        parent = g_file_get_parent (ancestor);
+        g_object_unref (ancestor);
+        ancestor = parent;
+    }
+
+    if (ancestor != NULL)
+    {
+        g_object_unref (ancestor);
+    }
+}
+
 gboolean
 caja_path_bar_set_path (CajaPathBar *path_bar, GFile *file_path)
 {
@@ -2116,6 +2143,8 @@ caja_path_bar_set_path (CajaPathBar *path_bar, GFile *file_path)
     g_return_val_if_fail (CAJA_IS_PATH_BAR (path_bar), FALSE);
     g_return_val_if_fail (file_path != NULL, FALSE);
 
+    prefetch_ancestors (file_path);
+
     /* Check whether the new path is already present in the pathbar as buttons.
      * This could be a parent directory or a previous selected subdirectory. */
     if (caja_path_bar_check_parent_path (path_bar, file_path, &button_data))
@@ -42,6 +42,7 @@
 #include <libcaja-private/caja-debug-log.h>
 #include <libcaja-private/caja-dnd.h>
 #include <libcaja-private/caja-bookmark.h>
+#include <libcaja-private/caja-directory-prefetch.h>
 #include <libcaja-private/caja-global-preferences.h>
 #include <libcaja-private/caja-sidebar-provider.h>
 #include <libcaja-private/caja-module.h>
@@ -60,6 +61,9 @@
 
 #define EJECT_BUTTON_XPAD 6
 
+/* Number of bookmarks, from the top, that are loaded in advance */
+#define PREFETCH_BOOKMARK_COUNT 3
+
 typedef struct
 {
     GtkScrolledWindow  parent;
@@ -474,7 +478,7 @@ update_places (CajaPlacesSidebar *sidebar)
     GDrive *drive;
     GList *volumes;
     GVolume *volume;
-    int bookmark_count, index;
+    int bookmark_count, index, prefetch_count;
     char *location, *mount_uri, *name, *desktop_path, *last_uri;
     const gchar *path;
     GIcon *icon;
@@ -810,6 +814,7 @@ update_places (CajaPlacesSidebar *sidebar)
 
     /* add bookmarks */
     bookmark_count = caja_bookmark_list_length (sidebar->bookmarks);
+    prefetch_count = 0;
 
     for (index = 0; index < bookmark_count; ++index) {
         bookmark = caja_bookmark_list_item_at (sidebar->bookmarks, index);
@@ -840,6 +845,12 @@ update_places (CajaPlacesSidebar *sidebar)
         compare_for_selection (sidebar,
                                location, mount_uri, last_uri,
                                &last_iter, &select_path);
+
+        if (prefetch_count < PREFETCH_BOOKMARK_COUNT) {
+            caja_directory_prefetch_add (root);
+            prefetch_count++;
+        }
+
         g_free (name);
         g_object_unref (root);
         g_object_unref (icon);
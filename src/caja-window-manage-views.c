@@ -42,6 +42,7 @@
 #include <eel/eel-vfs-extensions.h>
 
 #include <libcaja-private/caja-debug-log.h>
+#include <libcaja-private/caja-directory-prefetch.h>
 #include <libcaja-private/caja-extensions.h>
 #include <libcaja-private/caja-file-attributes.h>
 #include <libcaja-private/caja-file-utilities.h>
@@ -85,6 +86,29 @@
  */
 #define MAX_URI_IN_DIALOG_LENGTH 60
 
+/* Directories that were recently navigated away from are kept loaded
+ * and monitored, so that going back to them doesn't need to read them
+ * again. The cache is bounded both in entries and in total files. */
+#define RECENT_DIRECTORY_MAX_COUNT 10
+#define RECENT_DIRECTORY_MAX_FILES 50000
+
+#define RECENT_DIRECTORY_ATTRIBUTES \
+    (CAJA_FILE_ATTRIBUTES_FOR_ICON | \
+     CAJA_FILE_ATTRIBUTE_DIRECTORY_ITEM_COUNT | \
+     CAJA_FILE_ATTRIBUTE_INFO | \
+     CAJA_FILE_ATTRIBUTE_LINK_INFO | \
+     CAJA_FILE_ATTRIBUTE_MOUNT | \
+     CAJA_FILE_ATTRIBUTE_EXTENSION_INFO)
+
+typedef struct
+{
+    CajaDirectory *directory;
+    guint n_files;
+} RecentDirectory;
+
+static GList *recent_directories = NULL;
+static guint recent_directories_n_files = 0;
+
 static void begin_location_change                     (CajaWindowSlot         *slot,
         GFile                      *location,
         GFile                      *previous_location,
@@ -875,6 +899,107 @@ copy_object (gconstpointer obj,
     return g_object_ref (G_OBJECT (obj));
 }
 
+static GList *
+find_recent_directory (CajaDirectory *directory)
+{
+    GList *node;
+
+    for (node = recent_directories; node != NULL; node = node->next)
+    {
+        RecentDirectory *recent = node->data;
+
+        if (recent->directory == directory)
+        {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+release_recent_directory (GList *node)
+{
+    RecentDirectory *recent;
+
+    recent = node->data;
+    recent_directories = g_list_delete_link (recent_directories, node);
+    recent_directories_n_files -= recent->n_files;
+
+    caja_directory_file_monitor_remove (recent->directory, &recent_directories);
+    caja_directory_unref (recent->directory);
+    g_free (recent);
+}
+
+/* Called with the location a slot is leaving. */
+static void
+keep_recent_directory (GFile *location)
+{
+    CajaDirectory *directory;
+    RecentDirectory *recent;
+    GList *node, *files;
+
+    directory = caja_directory_get (location);
+
+    /* Remote directories are reloaded on every visit anyway, and a
+     * directory that wasn't loaded completely is not worth keeping. */
+    if (!caja_directory_is_local (directory) ||
+            CAJA_IS_SEARCH_DIRECTORY (directory) ||
+            !caja_directory_are_all_files_seen (directory))
+    {
+        caja_directory_unref (directory);
+        return;
+    }
+
+    node = find_recent_directory (directory);
+    if (node != NULL)
+    {
+        release_recent_directory (node);
+    }
+
+    files = caja_directory_get_file_list (directory);
+
+    recent = g_new0 (RecentDirectory, 1);
+    recent->directory = directory;
+    recent->n_files = g_list_length (files);
+
+    caja_file_list_free (files);
+
+    caja_directory_file_monitor_add (directory,
+                                     &recent_directories,
+                                     TRUE,
+                                     RECENT_DIRECTORY_ATTRIBUTES,
+                                     NULL, NULL);
+
+    recent_directories = g_list_prepend (recent_directories, recent);
+    recent_directories_n_files += recent->n_files;
+
+    while (recent_directories != NULL &&
+            (g_list_length (recent_directories) > RECENT_DIRECTORY_MAX_COUNT ||
+             recent_directories_n_files > RECENT_DIRECTORY_MAX_FILES))
+    {
+        release_recent_directory (g_list_last (recent_directories));
+    }
+}
+
+/* Called once a view monitors the location itself. */
+static void
+release_recent_directory_for_location (GFile *location)
+{
+    CajaDirectory *directory;
+    GList *node;
+
+    directory = caja_directory_get (location);
+
+    node = find_recent_directory (directory);
+    if (node != NULL)
+    {
+        release_recent_directory (node);
+    }
+
+    caja_directory_unref (directory);
+}
+
 /*
  * begin_location_change
  *
@@ -959,6 +1084,11 @@ begin_location_change (CajaWindowSlot *slot,
     slot->open_callback = callback;
     slot->open_callback_user_data = user_data;
 
+    if (type != CAJA_LOCATION_CHANGE_RELOAD)
+    {
+        caja_directory_prefetch_note_visit (location);
+    }
+
     directory = caja_directory_get (location);
 
     /* The code to force a reload is here because if we do it
@@ -990,15 +1120,27 @@ begin_location_change (CajaWindowSlot *slot,
 
     caja_directory_unref (directory);
 
-    /* Set current_bookmark scroll pos */
+    /* Set current_bookmark scroll pos and selection */
     if (slot->current_location_bookmark != NULL &&
             slot->content_view != NULL)
     {
         char *current_pos;
+        GList *selection;
 
         current_pos = caja_view_get_first_visible_file (slot->content_view);
         caja_bookmark_set_scroll_pos (slot->current_location_bookmark, current_pos);
         g_free (current_pos);
+
+        selection = caja_view_get_selection (slot->content_view);
+        caja_bookmark_set_selection (slot->current_location_bookmark, selection);
+        g_list_free_full (selection, g_object_unref);
+    }
+
+    if (slot->location != NULL &&
+            type != CAJA_LOCATION_CHANGE_RELOAD &&
+            !g_file_equal (slot->location, location))
+    {
+        keep_recent_directory (slot->location);
     }
 
     /* Get the info needed for view selection */
@@ -1943,6 +2085,10 @@ caja_window_report_load_complete (CajaWindow *window,
             caja_view_scroll_to_file (slot->content_view,
                                       slot->pending_scroll_to);
         }
+        if (slot->location != NULL)
+        {
+            release_recent_directory_for_location (slot->location);
+        }
         end_location_change (slot);
     }
 }
@@ -2342,12 +2488,14 @@ caja_navigation_window_back_or_forward (CajaNavigationWindow *window,
     {
         GFile *old_location;
         char *scroll_pos;
+        GList *selection;
 
         old_location = caja_window_slot_get_location (slot);
         scroll_pos = caja_bookmark_get_scroll_pos (bookmark);
+        selection = caja_bookmark_get_selection (bookmark);
         begin_location_change
         (slot,
-         location, old_location, NULL,
+         location, old_location, selection,
          back ? CAJA_LOCATION_CHANGE_BACK : CAJA_LOCATION_CHANGE_FORWARD,
          distance,
          scroll_pos,
@@ -2358,6 +2506,7 @@ caja_navigation_window_back_or_forward (CajaNavigationWindow *window,
         }
 
         g_free (scroll_pos);
+        g_list_free_full (selection, g_object_unref);
     }
 
     g_object_unref (location);
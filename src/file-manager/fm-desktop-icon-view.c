@@ -68,7 +68,9 @@
 
 #endif
 
-/* Timeout to check the desktop directory for updates */
+/* Timeout to check the desktop directory for updates, only used when
+ * the poll-for-changes preference is set. Otherwise the directory
+ * monitor of the model keeps the desktop up to date. */
 #define RESCAN_TIMEOUT 4
 
 struct _FMDesktopIconViewPrivate
@@ -94,6 +96,7 @@ static void     real_update_menus                                 (FMDirectoryVi
 static gboolean real_supports_zooming                             (FMDirectoryView        *view);
 static void     fm_desktop_icon_view_update_icon_container_fonts  (FMDesktopIconView      *view);
 static void     font_changed_callback                             (gpointer                callback_data);
+static void     poll_for_changes_changed_callback                 (gpointer                callback_data);
 
 G_DEFINE_TYPE_WITH_PRIVATE (FMDesktopIconView, fm_desktop_icon_view, FM_TYPE_ICON_VIEW)
 
@@ -312,6 +315,9 @@ fm_desktop_icon_view_dispose (GObject *object)
     g_signal_handlers_disconnect_by_func (caja_desktop_preferences,
                                           font_changed_callback,
                                           icon_view);
+    g_signal_handlers_disconnect_by_func (caja_desktop_preferences,
+                                          poll_for_changes_changed_callback,
+                                          icon_view);
 
     g_signal_handlers_disconnect_by_func (mate_lockdown_preferences,
                                           fm_directory_view_update_menus,
@@ -545,6 +551,40 @@ done_loading (CajaDirectory *model,
     desktop_dir_modify_time = buf.st_ctime;
 }
 
+static void
+poll_for_changes_changed_callback (gpointer callback_data)
+{
+    FMDesktopIconView *desktop_icon_view;
+    gboolean poll;
+
+    desktop_icon_view = FM_DESKTOP_ICON_VIEW (callback_data);
+
+    /* Wait for delayed_init (), there is no model to reload before */
+    if (desktop_icon_view->priv->delayed_init_signal != 0)
+    {
+        return;
+    }
+
+    /* Changes are normally picked up by the directory monitor. Poll
+     * only if there is no way to monitor, or if the user asked for it
+     * because the desktop is on a file system whose monitor does not
+     * report changes. */
+    poll = !caja_monitor_active () ||
+           g_settings_get_boolean (caja_desktop_preferences,
+                                   CAJA_PREFERENCES_DESKTOP_POLL_FOR_CHANGES);
+
+    if (poll && desktop_icon_view->priv->reload_desktop_timeout == 0)
+    {
+        desktop_icon_view->priv->reload_desktop_timeout =
+            g_timeout_add_seconds (RESCAN_TIMEOUT, do_desktop_rescan, desktop_icon_view);
+    }
+    else if (!poll && desktop_icon_view->priv->reload_desktop_timeout != 0)
+    {
+        g_source_remove (desktop_icon_view->priv->reload_desktop_timeout);
+        desktop_icon_view->priv->reload_desktop_timeout = 0;
+    }
+}
+
 /* This function is used because the CajaDirectory model does not
  * exist always in the desktop_icon_view, so we wait until it has been
  * instantiated.
@@ -557,14 +597,13 @@ delayed_init (FMDesktopIconView *desktop_icon_view)
                              "done_loading",
                              G_CALLBACK (done_loading), desktop_icon_view, 0);
 
-    /* Monitor desktop directory. */
-    desktop_icon_view->priv->reload_desktop_timeout =
-        g_timeout_add_seconds (RESCAN_TIMEOUT, do_desktop_rescan, desktop_icon_view);
-
     g_signal_handler_disconnect (desktop_icon_view,
                                  desktop_icon_view->priv->delayed_init_signal);
 
     desktop_icon_view->priv->delayed_init_signal = 0;
+
+    /* Poll the desktop directory if asked to. */
+    poll_for_changes_changed_callback (desktop_icon_view);
 }
 
 static void
@@ -613,15 +652,12 @@ fm_desktop_icon_view_init (FMDesktopIconView *desktop_icon_view)
     caja_icon_container_set_use_drop_shadows (icon_container, TRUE);
     fm_icon_container_set_sort_desktop (FM_ICON_CONTAINER (icon_container), TRUE);
 
-    /* Do a reload on the desktop if we don't have FAM, a smarter
-     * way to keep track of the items on the desktop.
+    /* Set up polling of the desktop once the model exists, see
+     * poll_for_changes_changed_callback ().
      */
-    if (!caja_monitor_active ())
-    {
-        desktop_icon_view->priv->delayed_init_signal = g_signal_connect_object
-                (desktop_icon_view, "begin_loading",
-                 G_CALLBACK (delayed_init), desktop_icon_view, 0);
-    }
+    desktop_icon_view->priv->delayed_init_signal = g_signal_connect_object
+            (desktop_icon_view, "begin_loading",
+             G_CALLBACK (delayed_init), desktop_icon_view, 0);
 
     caja_icon_container_set_is_fixed_size (icon_container, TRUE);
     caja_icon_container_set_is_desktop (icon_container, TRUE);
@@ -681,6 +717,11 @@ fm_desktop_icon_view_init (FMDesktopIconView *desktop_icon_view)
                               G_CALLBACK (font_changed_callback),
                               desktop_icon_view);
 
+    g_signal_connect_swapped (caja_desktop_preferences,
+                              "changed::" CAJA_PREFERENCES_DESKTOP_POLL_FOR_CHANGES,
+                              G_CALLBACK (poll_for_changes_changed_callback),
+                              desktop_icon_view);
+
     fm_desktop_icon_view_update_icon_container_fonts (desktop_icon_view);
 
     g_signal_connect_swapped (mate_lockdown_preferences,
@@ -132,6 +132,7 @@
 
 enum {
 	ADD_FILE,
+	ADD_FILES,
 	BEGIN_FILE_CHANGES,
 	BEGIN_LOADING,
 	CLEAR,
@@ -2920,6 +2921,56 @@ process_new_files (FMDirectoryView *view)
 
 }
 
+static void
+real_add_files (FMDirectoryView *view, GList *files, CajaDirectory *directory)
+{
+	GList *node;
+
+	for (node = files; node != NULL; node = node->next) {
+		g_signal_emit (view,
+			       signals[ADD_FILE], 0, node->data, directory);
+	}
+}
+
+/* Emit one add_files signal per directory, keeping the sort order
+ * of the files within each directory.
+ */
+static void
+emit_add_files (FMDirectoryView *view, GList *files_added)
+{
+	GHashTable *files_by_directory;
+	GList *directories, *files, *node;
+	FileAndDirectory *pending;
+
+	files_by_directory = g_hash_table_new (NULL, NULL);
+	directories = NULL;
+
+	for (node = files_added; node != NULL; node = node->next) {
+		pending = node->data;
+
+		files = g_hash_table_lookup (files_by_directory, pending->directory);
+		if (files == NULL) {
+			directories = g_list_prepend (directories, pending->directory);
+		}
+		g_hash_table_insert (files_by_directory, pending->directory,
+				     g_list_prepend (files, pending->file));
+	}
+
+	directories = g_list_reverse (directories);
+	for (node = directories; node != NULL; node = node->next) {
+		files = g_hash_table_lookup (files_by_directory, node->data);
+		files = g_list_reverse (files);
+
+		g_signal_emit (view,
+			       signals[ADD_FILES], 0, files, node->data);
+
+		g_list_free (files);
+	}
+
+	g_list_free (directories);
+	g_hash_table_destroy (files_by_directory);
+}
+
 static void
 process_old_files (FMDirectoryView *view)
 {
@@ -2937,10 +2988,18 @@ process_old_files (FMDirectoryView *view)
 
 		g_signal_emit (view, signals[BEGIN_FILE_CHANGES], 0);
 
-		for (node = files_added; node != NULL; node = node->next) {
-			pending = node->data;
-			g_signal_emit (view,
-				       signals[ADD_FILE], 0, pending->file, pending->directory);
+		/* Handlers connected to add_file (debuting files, new
+		 * folders, ...) need to see every file, so only batch
+		 * the additions when nobody is listening.
+		 */
+		if (g_signal_has_handler_pending (view, signals[ADD_FILE], 0, TRUE)) {
+			for (node = files_added; node != NULL; node = node->next) {
+				pending = node->data;
+				g_signal_emit (view,
+					       signals[ADD_FILE], 0, pending->file, pending->directory);
+			}
+		} else if (files_added != NULL) {
+			emit_add_files (view, files_added);
 		}
 
 		for (node = files_changed; node != NULL; node = node->next) {
@@ -11133,6 +11192,14 @@ fm_directory_view_class_init (FMDirectoryViewClass *klass)
 		              NULL, NULL,
 		              fm_marshal_VOID__OBJECT_OBJECT,
 		              G_TYPE_NONE, 2, CAJA_TYPE_FILE, CAJA_TYPE_DIRECTORY);
+	signals[ADD_FILES] =
+		g_signal_new ("add_files",
+		              G_TYPE_FROM_CLASS (klass),
+		              G_SIGNAL_RUN_LAST,
+		              G_STRUCT_OFFSET (FMDirectoryViewClass, add_files),
+		              NULL, NULL,
+		              fm_marshal_VOID__POINTER_OBJECT,
+		              G_TYPE_NONE, 2, G_TYPE_POINTER, CAJA_TYPE_DIRECTORY);
 	signals[BEGIN_FILE_CHANGES] =
 		g_signal_new ("begin_file_changes",
 		              G_TYPE_FROM_CLASS (klass),
@@ -11207,6 +11274,7 @@ fm_directory_view_class_init (FMDirectoryViewClass *klass)
 		              G_TYPE_NONE, 2, CAJA_TYPE_FILE, CAJA_TYPE_DIRECTORY);
 
 	klass->accepts_dragged_files = real_accepts_dragged_files;
+	klass->add_files = real_add_files;
 	klass->file_still_belongs = real_file_still_belongs;
 	klass->get_emblem_names_to_exclude = real_get_emblem_names_to_exclude;
 	klass->get_selected_icon_locations = real_get_selected_icon_locations;
@@ -86,6 +86,15 @@ struct FMDirectoryViewClass
     void    (* add_file) 		 (FMDirectoryView *view,
                                   CajaFile *file,
                                   CajaDirectory *directory);
+
+    /* The 'add_files' signal is emitted to add a batch of files from
+     * one directory. It is only used when nobody is connected to
+     * 'add_file'. The default implementation emits 'add_file' for
+     * each file; views that can insert many files at once replace it.
+     */
+    void    (* add_files)		 (FMDirectoryView *view,
+                                  GList *files,
+                                  CajaDirectory *directory);
     void    (* remove_file)		 (FMDirectoryView *view,
                                   CajaFile *file,
                                   CajaDirectory *directory);
@@ -187,11 +187,18 @@ fm_icon_container_prioritize_thumbnailing (CajaIconContainer *container,
         CajaIconData      *data)
 {
     CajaFile *file;
+    GList *list;
 
     file = (CajaFile *) data;
 
     g_assert (CAJA_IS_FILE (file));
 
+    /* Visible icons come here from bottom to top, so the top one ends
+     * up first. */
+    list = g_list_prepend (NULL, file);
+    caja_file_list_prioritize (list);
+    g_list_free (list);
+
     if (caja_file_is_thumbnailing (file))
     {
         char *uri;
@@ -202,6 +209,19 @@ fm_icon_container_prioritize_thumbnailing (CajaIconContainer *container,
     }
 }
 
+static const char *
+fm_icon_container_peek_icon_uri (CajaIconContainer *container,
+                                 CajaIconData      *data)
+{
+    CajaFile *file;
+
+    file = (CajaFile *) data;
+
+    g_assert (CAJA_IS_FILE (file));
+
+    return caja_file_peek_uri (file);
+}
+
 /*
  * Get the preference for which caption text should appear
  * beneath icons.
@@ -592,6 +612,7 @@ fm_icon_container_class_init (FMIconContainerClass *klass)
     ic_class->start_monitor_top_left = fm_icon_container_start_monitor_top_left;
     ic_class->stop_monitor_top_left = fm_icon_container_stop_monitor_top_left;
     ic_class->prioritize_thumbnailing = fm_icon_container_prioritize_thumbnailing;
+    ic_class->peek_icon_uri = fm_icon_container_peek_icon_uri;
 
     ic_class->compare_icons = fm_icon_container_compare_icons;
     ic_class->compare_icons_by_name = fm_icon_container_compare_icons_by_name;
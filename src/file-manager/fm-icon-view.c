@@ -48,6 +48,7 @@
 #include <libcaja-private/caja-clipboard-monitor.h>
 #include <libcaja-private/caja-directory-background.h>
 #include <libcaja-private/caja-directory.h>
+#include <libcaja-private/caja-directory-prefetch.h>
 #include <libcaja-private/caja-dnd.h>
 #include <libcaja-private/caja-file-utilities.h>
 #include <libcaja-private/caja-ui-utilities.h>
@@ -2449,6 +2450,23 @@ icon_container_preview_callback (CajaIconContainer *container,
 
     result = 0;
 
+    /* Get folders the pointer rests on loaded before they are opened. */
+    if (caja_file_is_directory (file))
+    {
+        if (start_flag)
+        {
+            GFile *location;
+
+            location = caja_file_get_location (file);
+            caja_directory_prefetch_hover (location);
+            g_object_unref (location);
+        }
+        else
+        {
+            caja_directory_prefetch_hover_cancel ();
+        }
+    }
+
     /* preview files based on the mime_type. */
     /* at first, we just handle sounds */
     if (should_preview_sound (file))
@@ -38,6 +38,7 @@
 
 #include <libcaja-private/caja-dnd.h>
 #include <libcaja-private/caja-global-preferences.h>
+#include <libcaja-private/caja-signaller.h>
 
 #include "fm-list-model.h"
 
@@ -81,6 +82,12 @@ struct FMListModelDetails
     GPtrArray *columns;
 
     GList *highlight_files;
+
+    /* Rendered icons and column strings are cached on the file
+     * entries. Bumping the generation invalidates all of them. */
+    guint cache_generation;
+    gboolean show_icons;
+    cairo_surface_t *blank_surfaces[CAJA_ZOOM_LEVEL_LARGEST + 1];
 };
 
 typedef struct
@@ -101,6 +108,18 @@ struct FileEntry
     GSequence *files;
     GSequenceIter *ptr;
     guint loaded : 1;
+
+    /* Render cache, see file_entry_validate_cache () */
+    guint cache_generation;
+    cairo_surface_t *icon_surface;
+    GList icon_surface_link; /* in icon_surface_lru */
+    int icon_surface_column;
+    int icon_surface_scale;
+    CajaFileIconFlags icon_surface_flags;
+    gboolean icon_surface_highlighted;
+    gboolean icon_surface_parent_writable;
+    char **column_strings;
+    guint n_column_strings;
 };
 
 G_DEFINE_TYPE_WITH_CODE (FMListModel, fm_list_model, G_TYPE_OBJECT,
@@ -119,9 +138,86 @@ static const GtkTargetEntry drag_types [] =
 
 static GtkTargetList *drag_target_list = NULL;
 
+/* Rows keep their rendered icon only while they are among the most
+ * recently drawn ones, across all list models. That is many more rows
+ * than fit on screen, while scrolling through a huge folder does not
+ * pin a surface for every row. */
+#define ICON_SURFACE_CACHE_SIZE 1024
+
+static GQueue icon_surface_lru = G_QUEUE_INIT; /* of FileEntry, most recent first */
+
+static void
+file_entry_clear_icon_surface (FileEntry *file_entry)
+{
+    if (file_entry->icon_surface != NULL)
+    {
+        g_queue_unlink (&icon_surface_lru, &file_entry->icon_surface_link);
+        cairo_surface_destroy (file_entry->icon_surface);
+        file_entry->icon_surface = NULL;
+    }
+}
+
+static void
+file_entry_set_icon_surface (FileEntry *file_entry,
+                             cairo_surface_t *surface)
+{
+    FileEntry *oldest;
+
+    file_entry_clear_icon_surface (file_entry);
+
+    if (surface == NULL)
+    {
+        return;
+    }
+
+    file_entry->icon_surface = surface;
+    file_entry->icon_surface_link.data = file_entry;
+    g_queue_push_head_link (&icon_surface_lru, &file_entry->icon_surface_link);
+
+    if (icon_surface_lru.length > ICON_SURFACE_CACHE_SIZE)
+    {
+        oldest = g_queue_peek_tail (&icon_surface_lru);
+        file_entry_clear_icon_surface (oldest);
+    }
+}
+
+static void
+file_entry_touch_icon_surface (FileEntry *file_entry)
+{
+    g_queue_unlink (&icon_surface_lru, &file_entry->icon_surface_link);
+    g_queue_push_head_link (&icon_surface_lru, &file_entry->icon_surface_link);
+}
+
+static void
+file_entry_clear_cache (FileEntry *file_entry)
+{
+    guint i;
+
+    file_entry_clear_icon_surface (file_entry);
+
+    for (i = 0; i < file_entry->n_column_strings; i++)
+    {
+        g_free (file_entry->column_strings[i]);
+    }
+    g_free (file_entry->column_strings);
+    file_entry->column_strings = NULL;
+    file_entry->n_column_strings = 0;
+}
+
+static void
+file_entry_validate_cache (FMListModel *model, FileEntry *file_entry)
+{
+    if (file_entry->cache_generation != model->details->cache_generation)
+    {
+        file_entry_clear_cache (file_entry);
+        file_entry->cache_generation = model->details->cache_generation;
+    }
+}
+
 static void
 file_entry_free (FileEntry *file_entry)
 {
+    file_entry_clear_cache (file_entry);
     caja_file_unref (file_entry->file);
     if (file_entry->reverse_map)
     {
@@ -279,15 +375,115 @@ fm_list_model_get_icon_scale (FMListModel *model)
     return retval;
 }
 
+static cairo_surface_t *
+fm_list_model_get_blank_surface (FMListModel *model, CajaZoomLevel zoom_level)
+{
+    int icon_size;
+
+    if (model->details->blank_surfaces[zoom_level] == NULL)
+    {
+        icon_size = caja_get_icon_size_for_zoom_level (zoom_level);
+        model->details->blank_surfaces[zoom_level] =
+            cairo_image_surface_create (CAIRO_FORMAT_ARGB32, icon_size, icon_size);
+    }
+
+    return model->details->blank_surfaces[zoom_level];
+}
+
+static cairo_surface_t *
+render_icon_surface (CajaFile *file,
+                     CajaZoomLevel zoom_level,
+                     int icon_scale,
+                     CajaFileIconFlags flags,
+                     gboolean highlighted,
+                     gboolean parent_writable)
+{
+    GdkPixbuf *icon, *rendered_icon;
+    GIcon *gicon, *emblemed_icon;
+    GList *emblem_icons, *l;
+    CajaIconInfo *icon_info;
+    GEmblem *emblem;
+    int icon_size;
+    char *emblems_to_ignore[3];
+    int i;
+    cairo_surface_t *surface;
+    const char *icon_name;
+
+    icon_size = caja_get_icon_size_for_zoom_level (zoom_level);
+
+    gicon = caja_file_get_gicon (file, flags);
+
+    /* render emblems with GEmblemedIcon */
+    i = 0;
+    emblems_to_ignore[i++] = CAJA_FILE_EMBLEM_NAME_TRASH;
+    if (!parent_writable) {
+        emblems_to_ignore[i++] = CAJA_FILE_EMBLEM_NAME_CANT_WRITE;
+    }
+    emblems_to_ignore[i++] = NULL;
+
+    emblem = NULL;
+    emblem_icons = caja_file_get_emblem_icons (file,
+                                               emblems_to_ignore);
+
+    if (emblem_icons != NULL) {
+        GIcon *emblem_icon;
+
+        emblem_icon = emblem_icons->data;
+        emblem = g_emblem_new (emblem_icon);
+        emblemed_icon = g_emblemed_icon_new (gicon, emblem);
+
+        g_object_unref (emblem);
+
+        for (l = emblem_icons->next; l != NULL; l = l->next) {
+            emblem_icon = l->data;
+            emblem = g_emblem_new (emblem_icon);
+            g_emblemed_icon_add_emblem
+                (G_EMBLEMED_ICON (emblemed_icon), emblem);
+
+            g_object_unref (emblem);
+        }
+
+        g_list_free_full (emblem_icons, g_object_unref);
+
+        g_object_unref (gicon);
+        gicon = emblemed_icon;
+    }
+
+    icon_info = caja_file_get_icon (file, icon_size, icon_scale, flags);
+    icon_name = caja_icon_info_get_used_name (icon_info);
+
+    if (icon_name != NULL) {
+        g_object_unref (icon_info);
+        icon_info = caja_icon_info_lookup (gicon, icon_size, icon_scale);
+    }
+    icon = caja_icon_info_get_pixbuf_at_size (icon_info, icon_size);
+
+    g_object_unref (icon_info);
+    g_object_unref (gicon);
+
+    if (highlighted)
+    {
+        rendered_icon = eel_create_spotlight_pixbuf (icon);
+
+        if (rendered_icon != NULL)
+        {
+            g_object_unref (icon);
+            icon = rendered_icon;
+        }
+    }
+
+    surface = gdk_cairo_surface_create_from_pixbuf (icon, icon_scale, NULL);
+    g_object_unref (icon);
+
+    return surface;
+}
+
 static void
 fm_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int column, GValue *value)
 {
     FMListModel *model;
     FileEntry *file_entry;
     CajaFile *file;
-    GdkPixbuf *rendered_icon;
-    GIcon *emblemed_icon;
-    GList *emblem_icons, *l;
     CajaZoomLevel zoom_level;
     CajaFileIconFlags flags;
 
@@ -318,36 +514,21 @@ fm_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int column
     case FM_LIST_MODEL_LARGE_ICON_COLUMN:
     case FM_LIST_MODEL_LARGER_ICON_COLUMN:
     case FM_LIST_MODEL_LARGEST_ICON_COLUMN:
-        if (!g_settings_get_boolean (caja_preferences, CAJA_PREFERENCES_SHOW_ICONS_IN_LIST_VIEW)) {
-            cairo_surface_t *surface;
-            int icon_size;
-
-            g_value_init (value, CAIRO_GOBJECT_TYPE_SURFACE);
+        g_value_init (value, CAIRO_GOBJECT_TYPE_SURFACE);
 
-            zoom_level = fm_list_model_get_zoom_level_from_column_id (column);
-            icon_size = caja_get_icon_size_for_zoom_level (zoom_level);
+        zoom_level = fm_list_model_get_zoom_level_from_column_id (column);
 
-            surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, icon_size, icon_size);
-            g_value_take_boxed (value, surface);
+        if (!model->details->show_icons) {
+            g_value_set_boxed (value, fm_list_model_get_blank_surface (model, zoom_level));
             break;
         }
-        g_value_init (value, CAIRO_GOBJECT_TYPE_SURFACE);
 
         if (file != NULL)
         {
-            GdkPixbuf *icon;
-            GIcon *gicon;
-            CajaIconInfo *icon_info;
-            GEmblem *emblem;
-            int icon_size, icon_scale;
+            int icon_scale;
+            gboolean highlighted, parent_writable;
             CajaFile *parent_file;
-            char *emblems_to_ignore[3];
-            int i;
-            cairo_surface_t *surface;
-            const char *icon_name;
 
-            zoom_level = fm_list_model_get_zoom_level_from_column_id (column);
-            icon_size = caja_get_icon_size_for_zoom_level (zoom_level);
             icon_scale = fm_list_model_get_icon_scale (model);
 
             flags = CAJA_FILE_ICON_FLAGS_USE_THUMBNAILS |
@@ -355,97 +536,62 @@ fm_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int column
                     CAJA_FILE_ICON_FLAGS_USE_MOUNT_ICON_AS_EMBLEM;
             if (model->details->drag_view != NULL)
             {
-                GtkTreePath *path_a;
+                GtkTreePath *drag_dest_path;
+                GtkTreeIter drag_dest_iter;
 
                 gtk_tree_view_get_drag_dest_row (model->details->drag_view,
-                                                 &path_a,
+                                                 &drag_dest_path,
                                                  NULL);
-                if (path_a != NULL)
+                if (drag_dest_path != NULL)
                 {
-                    GtkTreePath *path_b;
-
-                    path_b = gtk_tree_model_get_path (tree_model, iter);
-
-                    if (gtk_tree_path_compare (path_a, path_b) == 0)
+                    if (fm_list_model_get_iter (tree_model, &drag_dest_iter, drag_dest_path) &&
+                            drag_dest_iter.user_data == iter->user_data)
                     {
                         flags |= CAJA_FILE_ICON_FLAGS_FOR_DRAG_ACCEPT;
                     }
 
-                    gtk_tree_path_free (path_a);
-                    gtk_tree_path_free (path_b);
+                    gtk_tree_path_free (drag_dest_path);
                 }
             }
 
-            gicon = caja_file_get_gicon (file, flags);
+            highlighted = model->details->highlight_files != NULL &&
+                          g_list_find_custom (model->details->highlight_files,
+                                              file, (GCompareFunc) caja_file_compare_location) != NULL;
 
-            /* render emblems with GEmblemedIcon */
+            /* The parent's writability decides about the "cant-write"
+             * emblem, it changes without the file changing */
+            parent_writable = TRUE;
             parent_file = caja_file_get_parent (file);
-            i = 0;
-            emblems_to_ignore[i++] = CAJA_FILE_EMBLEM_NAME_TRASH;
-            if (parent_file) {
-            	if (!caja_file_can_write (parent_file)) {
-                    emblems_to_ignore[i++] = CAJA_FILE_EMBLEM_NAME_CANT_WRITE;
-            	}
-            	caja_file_unref (parent_file);
-            }
-            emblems_to_ignore[i++] = NULL;
-
-            emblem = NULL;
-            emblem_icons = caja_file_get_emblem_icons (file,
-            					       emblems_to_ignore);
-
-            if (emblem_icons != NULL) {
-                GIcon *emblem_icon;
-
-                emblem_icon = emblem_icons->data;
-                emblem = g_emblem_new (emblem_icon);
-                emblemed_icon = g_emblemed_icon_new (gicon, emblem);
-
-                g_object_unref (emblem);
-
-            	for (l = emblem_icons->next; l != NULL; l = l->next) {
-            	    emblem_icon = l->data;
-            	    emblem = g_emblem_new (emblem_icon);
-            	    g_emblemed_icon_add_emblem
-            	        (G_EMBLEMED_ICON (emblemed_icon), emblem);
-
-                    g_object_unref (emblem);
-            	}
-
-                g_list_free_full (emblem_icons, g_object_unref);
-
-            	g_object_unref (gicon);
-            	gicon = emblemed_icon;
+            if (parent_file != NULL)
+            {
+                parent_writable = caja_file_can_write (parent_file);
+                caja_file_unref (parent_file);
             }
 
-            icon_info = caja_file_get_icon (file, icon_size, icon_scale, flags);
-            icon_name = caja_icon_info_get_used_name (icon_info);
-
-            if (icon_name != NULL) {
-                g_object_unref (icon_info);
-                icon_info = caja_icon_info_lookup (gicon, icon_size, icon_scale);
+            file_entry_validate_cache (model, file_entry);
+            if (file_entry->icon_surface == NULL ||
+                    file_entry->icon_surface_column != column ||
+                    file_entry->icon_surface_scale != icon_scale ||
+                    file_entry->icon_surface_flags != flags ||
+                    file_entry->icon_surface_highlighted != highlighted ||
+                    file_entry->icon_surface_parent_writable != parent_writable)
+            {
+                file_entry_set_icon_surface (file_entry,
+                                             render_icon_surface (file, zoom_level, icon_scale,
+                                                                  flags, highlighted,
+                                                                  parent_writable));
+                file_entry->icon_surface_column = column;
+                file_entry->icon_surface_scale = icon_scale;
+                file_entry->icon_surface_flags = flags;
+                file_entry->icon_surface_highlighted = highlighted;
+                file_entry->icon_surface_parent_writable = parent_writable;
             }
-            icon = caja_icon_info_get_pixbuf_at_size (icon_info, icon_size);
-
-            g_object_unref (icon_info);
-            g_object_unref (gicon);
-
-            if (model->details->highlight_files != NULL &&
-                    g_list_find_custom (model->details->highlight_files,
-                                        file, (GCompareFunc) caja_file_compare_location))
+            else
             {
-                rendered_icon = eel_create_spotlight_pixbuf (icon);
-
-                if (rendered_icon != NULL)
-                {
-                    g_object_unref (icon);
-                    icon = rendered_icon;
-                }
+                file_entry_touch_icon_surface (file_entry);
             }
 
-            surface = gdk_cairo_surface_create_from_pixbuf (icon, icon_scale, NULL);
-            g_value_take_boxed (value, surface);
-            g_object_unref (icon);
+            g_value_set_boxed (value, file_entry->icon_surface);
         }
         break;
     case FM_LIST_MODEL_FILE_NAME_IS_EDITABLE_COLUMN:
@@ -466,11 +612,27 @@ fm_list_model_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter, int column
                           NULL);
             if (file != NULL)
             {
-                char *str;
+                guint column_index;
+
+                column_index = column - FM_LIST_MODEL_NUM_COLUMNS;
+
+                file_entry_validate_cache (model, file_entry);
+                if (column_index >= file_entry->n_column_strings)
+                {
+                    file_entry->column_strings = g_renew (char *, file_entry->column_strings,
+                                                          model->details->columns->len);
+                    memset (file_entry->column_strings + file_entry->n_column_strings, 0,
+                            (model->details->columns->len - file_entry->n_column_strings) * sizeof (char *));
+                    file_entry->n_column_strings = model->details->columns->len;
+                }
+
+                if (file_entry->column_strings[column_index] == NULL)
+                {
+                    file_entry->column_strings[column_index] =
+                        caja_file_get_string_attribute_with_default_q (file, attribute);
+                }
 
-                str = caja_file_get_string_attribute_with_default_q (file,
-                        attribute);
-                g_value_take_string (value, str);
+                g_value_set_string (value, file_entry->column_strings[column_index]);
             }
             else if (attribute == attribute_name_q)
             {
@@ -943,7 +1105,6 @@ each_path_get_data_binder (CajaDragEachSelectedItemDataGet data_get,
 {
     DragDataGetInfo *info;
     GList *l;
-    char *uri;
     GdkRectangle cell_area;
     GtkTreeViewColumn *column;
     CajaFile *file = NULL;
@@ -971,16 +1132,12 @@ each_path_get_data_binder (CajaDragEachSelectedItemDataGet data_get,
              column,
              &cell_area);
 
-            uri = caja_file_get_uri (file);
-
-            (*data_get) (uri,
+            (*data_get) (caja_file_peek_uri (file),
                          0,
                          cell_area.y - info->model->details->drag_begin_y,
                          cell_area.width, cell_area.height,
                          data);
 
-            g_free (uri);
-
             caja_file_unref (file);
         }
 
@@ -1150,6 +1307,174 @@ fm_list_model_add_file (FMListModel *model, CajaFile *file,
     return TRUE;
 }
 
+static int
+file_entry_ptr_compare_func (gconstpointer a,
+                             gconstpointer b,
+                             gpointer      user_data)
+{
+    return fm_list_model_file_entry_compare_func (*(FileEntry **) a,
+                                                  *(FileEntry **) b,
+                                                  user_data);
+}
+
+/* Returns the first row in [begin, end) that sorts after file_entry */
+static GSequenceIter *
+search_insert_position (FMListModel   *model,
+                        GSequenceIter *begin,
+                        GSequenceIter *end,
+                        FileEntry     *file_entry)
+{
+    GSequenceIter *middle;
+
+    while (begin != end)
+    {
+        middle = g_sequence_range_get_midpoint (begin, end);
+        if (fm_list_model_file_entry_compare_func (g_sequence_get (middle), file_entry, model) <= 0)
+        {
+            begin = g_sequence_iter_next (middle);
+        }
+        else
+        {
+            end = middle;
+        }
+    }
+
+    return begin;
+}
+
+/* Adds all files of one directory at once. The new entries are sorted
+ * once and then merged into the existing rows in ascending order, each
+ * one found by a binary search starting after the previous one, so
+ * that rows are announced in order and single additions to a big
+ * folder stay logarithmic.
+ */
+void
+fm_list_model_add_files (FMListModel *model, GList *files,
+                         CajaDirectory *directory)
+{
+    GtkTreeIter iter;
+    GtkTreePath *parent_path, *path;
+    FileEntry *file_entry, *parent_entry;
+    GSequenceIter *ptr, *parent_ptr;
+    GSequence *sequence;
+    GHashTable *parent_hash, *new_files;
+    GPtrArray *new_entries;
+    GList *l;
+    gboolean replace_dummy;
+    int position;
+    guint i;
+
+    parent_ptr = g_hash_table_lookup (model->details->directory_reverse_map,
+                                      directory);
+    if (parent_ptr)
+    {
+        parent_entry = g_sequence_get (parent_ptr);
+        parent_hash = parent_entry->reverse_map;
+        sequence = parent_entry->files;
+    }
+    else
+    {
+        parent_entry = NULL;
+        parent_hash = model->details->top_reverse_map;
+        sequence = model->details->files;
+    }
+
+    new_entries = g_ptr_array_sized_new (g_list_length (files));
+    new_files = g_hash_table_new (NULL, NULL);
+    for (l = files; l != NULL; l = l->next)
+    {
+        if (g_hash_table_lookup (parent_hash, l->data) != NULL ||
+            !g_hash_table_add (new_files, l->data))
+        {
+            g_warning ("file already in tree (parent_ptr: %p)!!!\n", parent_ptr);
+            continue;
+        }
+
+        file_entry = g_new0 (FileEntry, 1);
+        file_entry->file = caja_file_ref (l->data);
+        file_entry->parent = parent_entry;
+        g_ptr_array_add (new_entries, file_entry);
+    }
+    g_hash_table_destroy (new_files);
+
+    if (new_entries->len == 0)
+    {
+        g_ptr_array_free (new_entries, TRUE);
+        return;
+    }
+
+    g_ptr_array_sort_with_data (new_entries, file_entry_ptr_compare_func, model);
+
+    replace_dummy = FALSE;
+    if (parent_entry != NULL)
+    {
+        /* See fm_list_model_add_file () */
+        parent_entry->loaded = 1;
+        if (g_sequence_get_length (sequence) == 1)
+        {
+            GSequenceIter *dummy_ptr = g_sequence_get_iter_at_pos (sequence, 0);
+            FileEntry *dummy_entry = g_sequence_get (dummy_ptr);
+            if (dummy_entry->file == NULL)
+            {
+                model->details->stamp++;
+                g_sequence_remove (dummy_ptr);
+
+                replace_dummy = TRUE;
+            }
+        }
+
+        fm_list_model_ptr_to_iter (model, parent_ptr, &iter);
+        parent_path = gtk_tree_model_get_path (GTK_TREE_MODEL (model), &iter);
+    }
+    else
+    {
+        parent_path = gtk_tree_path_new ();
+    }
+
+    ptr = g_sequence_get_begin_iter (sequence);
+    for (i = 0; i < new_entries->len; i++)
+    {
+        file_entry = g_ptr_array_index (new_entries, i);
+
+        ptr = search_insert_position (model, ptr,
+                                      g_sequence_get_end_iter (sequence),
+                                      file_entry);
+        position = g_sequence_iter_get_position (ptr);
+
+        file_entry->ptr = g_sequence_insert_before (ptr, file_entry);
+        g_hash_table_insert (parent_hash, file_entry->file, file_entry->ptr);
+
+        iter.stamp = model->details->stamp;
+        iter.user_data = file_entry->ptr;
+
+        path = gtk_tree_path_copy (parent_path);
+        gtk_tree_path_append_index (path, position);
+
+        if (replace_dummy && i == 0)
+        {
+            gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+        }
+        else
+        {
+            gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+        }
+
+        if (caja_file_is_directory (file_entry->file))
+        {
+            file_entry->files = g_sequence_new ((GDestroyNotify)file_entry_free);
+
+            add_dummy_row (model, file_entry);
+
+            gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (model),
+                                                  path, &iter);
+        }
+        gtk_tree_path_free (path);
+    }
+
+    gtk_tree_path_free (parent_path);
+    g_ptr_array_free (new_entries, TRUE);
+}
+
 void
 fm_list_model_file_changed (FMListModel *model, CajaFile *file,
                             CajaDirectory *directory)
@@ -1167,6 +1492,8 @@ fm_list_model_file_changed (FMListModel *model, CajaFile *file,
         return;
     }
 
+    file_entry_clear_cache (g_sequence_get (ptr));
+
     pos_before = g_sequence_iter_get_position (ptr);
 
     g_sequence_sort_changed (ptr, fm_list_model_file_entry_compare_func, model);
@@ -1644,17 +1971,48 @@ fm_list_model_add_column (FMListModel *model,
     return FM_LIST_MODEL_NUM_COLUMNS + (model->details->columns->len - 1);
 }
 
+static void
+preferences_changed_callback (GSettings *settings,
+                              const char *key,
+                              FMListModel *model)
+{
+    /* Any of the global preferences may change how icons and
+     * attributes are rendered (date format, size units, ...) */
+    model->details->show_icons = g_settings_get_boolean (caja_preferences,
+                                 CAJA_PREFERENCES_SHOW_ICONS_IN_LIST_VIEW);
+    model->details->cache_generation++;
+}
+
+static void
+render_cache_changed_callback (FMListModel *model)
+{
+    /* A new day for informal dates, or a new icon theme */
+    model->details->cache_generation++;
+}
+
 static void
 fm_list_model_dispose (GObject *object)
 {
     FMListModel *model;
+    int i;
 
     model = FM_LIST_MODEL (object);
 
-    if (model->details->columns)
+    g_signal_handlers_disconnect_by_func (caja_preferences,
+                                          preferences_changed_callback,
+                                          model);
+
+    for (i = 0; i <= CAJA_ZOOM_LEVEL_LARGEST; i++)
     {
-        int i;
+        if (model->details->blank_surfaces[i] != NULL)
+        {
+            cairo_surface_destroy (model->details->blank_surfaces[i]);
+            model->details->blank_surfaces[i] = NULL;
+        }
+    }
 
+    if (model->details->columns)
+    {
         for (i = 0; i < model->details->columns->len; i++)
         {
             g_object_unref (model->details->columns->pdata[i]);
@@ -1711,6 +2069,17 @@ fm_list_model_init (FMListModel *model)
     model->details->stamp = g_random_int ();
     model->details->sort_attribute = 0;
     model->details->columns = g_ptr_array_new ();
+    model->details->show_icons = g_settings_get_boolean (caja_preferences,
+                                 CAJA_PREFERENCES_SHOW_ICONS_IN_LIST_VIEW);
+
+    g_signal_connect (caja_preferences, "changed",
+                      G_CALLBACK (preferences_changed_callback), model);
+    g_signal_connect_object (caja_signaller_get_current (), "day_changed",
+                             G_CALLBACK (render_cache_changed_callback), model,
+                             G_CONNECT_SWAPPED);
+    g_signal_connect_object (gtk_icon_theme_get_default (), "changed",
+                             G_CALLBACK (render_cache_changed_callback), model,
+                             G_CONNECT_SWAPPED);
 }
 
 static void
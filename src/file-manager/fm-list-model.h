@@ -80,6 +80,9 @@ GType    fm_list_model_get_type                          (void);
 gboolean fm_list_model_add_file                          (FMListModel          *model,
         CajaFile         *file,
         CajaDirectory    *directory);
+void     fm_list_model_add_files                         (FMListModel          *model,
+        GList            *files,
+        CajaDirectory    *directory);
 void     fm_list_model_file_changed                      (FMListModel          *model,
         CajaFile         *file,
         CajaDirectory    *directory);
@@ -48,6 +48,7 @@
 #include <libcaja-private/caja-column-utilities.h>
 #include <libcaja-private/caja-debug-log.h>
 #include <libcaja-private/caja-directory-background.h>
+#include <libcaja-private/caja-directory-prefetch.h>
 #include <libcaja-private/caja-dnd.h>
 #include <libcaja-private/caja-file-dnd.h>
 #include <libcaja-private/caja-file-utilities.h>
@@ -90,6 +91,11 @@ struct FMListViewDetails
 
     GtkTreePath *hover_path;
 
+    /* Folder under the pointer, for prefetching */
+    CajaFile *prefetch_hover_file;
+
+    guint prioritize_visible_id;
+
     guint drag_button;
     int drag_x;
     int drag_y;
@@ -125,6 +131,10 @@ struct SelectionForeachData
 /* We wait two seconds after row is collapsed to unload the subdirectory */
 #define COLLAPSE_TO_UNLOAD_DELAY 2
 
+/* Number of unloaded subdirectories kept monitored so that expanding
+ * them again does not reload them from scratch */
+#define WARM_SUBDIRECTORY_COUNT 8
+
 /* Wait for the rename to end when activating a file being renamed */
 #define WAIT_FOR_RENAME_ON_ACTIVATE 200
 
@@ -137,6 +147,8 @@ static char **                  default_column_order_auto_value;
 static GdkCursor *              hand_cursor = NULL;
 
 static GtkTargetList *          source_target_list = NULL;
+static GList *                  warm_subdirectories = NULL;
+static guint                    list_view_count = 0;
 
 static GList *fm_list_view_get_selection                   (FMDirectoryView   *view);
 static GList *fm_list_view_get_selection_for_file_transfer (FMDirectoryView   *view);
@@ -519,6 +531,55 @@ drag_begin_callback (GtkWidget *widget,
                             (GDestroyNotify)ref_list_free);
 }
 
+static void
+set_prefetch_hover_file (FMListView *view, CajaFile *file)
+{
+    GFile *location;
+
+    if (file == view->details->prefetch_hover_file)
+    {
+        return;
+    }
+
+    caja_file_unref (view->details->prefetch_hover_file);
+    view->details->prefetch_hover_file = caja_file_ref (file);
+
+    if (file != NULL)
+    {
+        location = caja_file_get_location (file);
+        caja_directory_prefetch_hover (location);
+        g_object_unref (location);
+    }
+    else
+    {
+        caja_directory_prefetch_hover_cancel ();
+    }
+}
+
+static void
+update_prefetch_hover (FMListView *view, int x, int y)
+{
+    GtkTreePath *path;
+    CajaFile *file;
+
+    file = NULL;
+    if (gtk_tree_view_get_path_at_pos (view->details->tree_view,
+                                       x, y, &path, NULL, NULL, NULL))
+    {
+        file = fm_list_model_file_for_path (view->details->model, path);
+        gtk_tree_path_free (path);
+    }
+
+    if (file != NULL && !caja_file_is_directory (file))
+    {
+        caja_file_unref (file);
+        file = NULL;
+    }
+
+    set_prefetch_hover_file (view, file);
+    caja_file_unref (file);
+}
+
 static gboolean
 motion_notify_callback (GtkWidget *widget,
                         GdkEventMotion *event,
@@ -561,6 +622,8 @@ motion_notify_callback (GtkWidget *widget,
         }
     }
 
+    update_prefetch_hover (view, event->x, event->y);
+
     if (view->details->drag_button != 0)
     {
         if (!source_target_list)
@@ -604,6 +667,8 @@ leave_notify_callback (GtkWidget *widget,
         view->details->hover_path = NULL;
     }
 
+    set_prefetch_hover_file (view, NULL);
+
     return FALSE;
 }
 
@@ -934,6 +999,63 @@ popup_menu_callback (GtkWidget *widget, gpointer callback_data)
     return TRUE;
 }
 
+#define WARM_SUBDIRECTORY_ATTRIBUTES \
+    (CAJA_FILE_ATTRIBUTES_FOR_ICON | \
+     CAJA_FILE_ATTRIBUTE_DIRECTORY_ITEM_COUNT | \
+     CAJA_FILE_ATTRIBUTE_INFO | \
+     CAJA_FILE_ATTRIBUTE_LINK_INFO | \
+     CAJA_FILE_ATTRIBUTE_MOUNT | \
+     CAJA_FILE_ATTRIBUTE_EXTENSION_INFO)
+
+/* The warm list is shared by all list views, since they all get the
+ * same CajaDirectory for a given location. It holds a monitor on each
+ * directory so that its files stay loaded and up to date.
+ */
+static void
+release_warm_subdirectory (CajaDirectory *directory)
+{
+    warm_subdirectories = g_list_remove (warm_subdirectories, directory);
+    caja_directory_file_monitor_remove (directory, &warm_subdirectories);
+    caja_directory_unref (directory);
+}
+
+/* Called when the last list view goes away */
+static void
+release_warm_subdirectories (void)
+{
+    while (warm_subdirectories != NULL)
+    {
+        release_warm_subdirectory (warm_subdirectories->data);
+    }
+}
+
+static void
+keep_subdirectory_warm (CajaDirectory *directory)
+{
+    GList *node;
+
+    node = g_list_find (warm_subdirectories, directory);
+    if (node != NULL)
+    {
+        warm_subdirectories = g_list_remove_link (warm_subdirectories, node);
+        warm_subdirectories = g_list_concat (node, warm_subdirectories);
+        return;
+    }
+
+    caja_directory_ref (directory);
+    caja_directory_file_monitor_add (directory,
+                                     &warm_subdirectories,
+                                     TRUE,
+                                     WARM_SUBDIRECTORY_ATTRIBUTES,
+                                     NULL, NULL);
+    warm_subdirectories = g_list_prepend (warm_subdirectories, directory);
+
+    while (g_list_length (warm_subdirectories) > WARM_SUBDIRECTORY_COUNT)
+    {
+        release_warm_subdirectory (g_list_last (warm_subdirectories)->data);
+    }
+}
+
 static void
 subdirectory_done_loading_callback (CajaDirectory *directory, FMListView *view)
 {
@@ -961,6 +1083,13 @@ row_expanded_callback (GtkTreeView *treeview, GtkTreeIter *iter, GtkTreePath *pa
 
         fm_directory_view_add_subdirectory (FM_DIRECTORY_VIEW (view), directory);
 
+        /* The view monitors the directory now, so it no longer
+         * needs to be kept warm */
+        if (g_list_find (warm_subdirectories, directory) != NULL)
+        {
+            release_warm_subdirectory (directory);
+        }
+
         if (caja_directory_are_all_files_seen (directory))
         {
             fm_list_model_subdirectory_done_loading (view->details->model,
@@ -1030,7 +1159,7 @@ row_collapsed_callback (GtkTreeView *treeview, GtkTreeIter *iter, GtkTreePath *p
 {
     FMListView *view;
     CajaFile *file;
-    CajaDirectory *directory;
+    CajaDirectory *directory, *subdirectory;
     GtkTreeIter parent;
     struct UnloadDelayData *unload_data;
     GtkTreeModel *model;
@@ -1041,6 +1170,7 @@ row_collapsed_callback (GtkTreeView *treeview, GtkTreeIter *iter, GtkTreePath *p
 
     gtk_tree_model_get (model, iter,
                         FM_LIST_MODEL_FILE_COLUMN, &file,
+                        FM_LIST_MODEL_SUBDIRECTORY_COLUMN, &subdirectory,
                         -1);
 
     directory = NULL;
@@ -1058,6 +1188,26 @@ row_collapsed_callback (GtkTreeView *treeview, GtkTreeIter *iter, GtkTreePath *p
                     uri);
     g_free (uri);
 
+    /* A subdirectory that is still loading is unloaded right away,
+     * which cancels its pending I/O instead of letting it compete
+     * with the rows that are still expanded. */
+    if (subdirectory != NULL &&
+            !caja_directory_are_all_files_seen (subdirectory))
+    {
+        fm_list_model_unload_subdirectory (view->details->model, iter);
+        caja_directory_unref (subdirectory);
+        if (directory != NULL)
+        {
+            caja_directory_unref (directory);
+        }
+        caja_file_unref (file);
+        return;
+    }
+    if (subdirectory != NULL)
+    {
+        caja_directory_unref (subdirectory);
+    }
+
     unload_data = g_new (struct UnloadDelayData, 1);
     unload_data->view = view;
     unload_data->file = file;
@@ -1092,6 +1242,14 @@ subdirectory_unloaded_callback (FMListModel *model,
     g_signal_handlers_disconnect_by_func (directory,
                                           G_CALLBACK (subdirectory_done_loading_callback),
                                           view);
+
+    /* Only fully loaded directories are worth keeping around; for
+     * the others dropping the last monitor cancels the load. */
+    if (caja_directory_are_all_files_seen (directory))
+    {
+        keep_subdirectory_warm (directory);
+    }
+
     fm_directory_view_remove_subdirectory (FM_DIRECTORY_VIEW (view), directory);
 }
 
@@ -1647,6 +1805,121 @@ get_icon_scale_callback (FMListModel *model,
     return gtk_widget_get_scale_factor (GTK_WIDGET (view->details->tree_view));
 }
 
+/* Number of rows at most that are on screen */
+#define PRIORITIZE_VISIBLE_MAX_ROWS 200
+
+/* Moves to the next row in display order, going into expanded rows */
+static gboolean
+get_next_displayed_row (GtkTreeModel *model,
+                        GtkTreeIter *iter,
+                        gboolean expanded)
+{
+    GtkTreeIter next;
+
+    if (expanded && gtk_tree_model_iter_children (model, &next, iter))
+    {
+        *iter = next;
+        return TRUE;
+    }
+
+    for (;;)
+    {
+        next = *iter;
+        if (gtk_tree_model_iter_next (model, &next))
+        {
+            *iter = next;
+            return TRUE;
+        }
+        if (!gtk_tree_model_iter_parent (model, &next, iter))
+        {
+            return FALSE;
+        }
+        *iter = next;
+    }
+}
+
+static gboolean
+prioritize_visible_files_callback (gpointer callback_data)
+{
+    FMListView *view;
+    GtkTreeModel *model;
+    GtkTreePath *start_path, *end_path, *path;
+    GtkTreeIter iter;
+    CajaFile *file;
+    GList *files;
+    gboolean expanded, past_end;
+    int count;
+
+    view = FM_LIST_VIEW (callback_data);
+    view->details->prioritize_visible_id = 0;
+
+    if (!gtk_tree_view_get_visible_range (view->details->tree_view,
+                                          &start_path, &end_path))
+    {
+        return FALSE;
+    }
+
+    model = GTK_TREE_MODEL (view->details->model);
+    files = NULL;
+
+    if (gtk_tree_model_get_iter (model, &iter, start_path))
+    {
+        for (count = 0; count < PRIORITIZE_VISIBLE_MAX_ROWS; count++)
+        {
+            path = gtk_tree_model_get_path (model, &iter);
+            past_end = gtk_tree_path_compare (path, end_path) > 0;
+            expanded = gtk_tree_view_row_expanded (view->details->tree_view, path);
+            gtk_tree_path_free (path);
+
+            if (past_end)
+            {
+                break;
+            }
+
+            gtk_tree_model_get (model, &iter,
+                                FM_LIST_MODEL_FILE_COLUMN, &file,
+                                -1);
+            if (file != NULL)
+            {
+                files = g_list_prepend (files, file);
+            }
+
+            if (!get_next_displayed_row (model, &iter, expanded))
+            {
+                break;
+            }
+        }
+    }
+
+    files = g_list_reverse (files);
+    caja_file_list_prioritize (files);
+    caja_file_list_free (files);
+
+    gtk_tree_path_free (start_path);
+    gtk_tree_path_free (end_path);
+
+    return FALSE;
+}
+
+/* Let the files on screen get their attributes first, again whenever
+ * the view scrolls or gets more files. */
+static void
+schedule_prioritize_visible_files (FMListView *view)
+{
+    if (view->details->prioritize_visible_id == 0)
+    {
+        view->details->prioritize_visible_id =
+            g_idle_add (prioritize_visible_files_callback, view);
+    }
+}
+
+static void
+vadjustment_value_changed_callback (GtkAdjustment *adjustment,
+                                    gpointer callback_data)
+{
+    schedule_prioritize_visible_files (FM_LIST_VIEW (callback_data));
+}
+
 static void
 create_and_set_up_tree_view (FMListView *view)
 {
@@ -1849,6 +2122,11 @@ create_and_set_up_tree_view (FMListView *view)
 
     atk_obj = gtk_widget_get_accessible (GTK_WIDGET (view->details->tree_view));
     atk_object_set_name (atk_obj, _("List View"));
+
+    g_signal_connect_object (gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (view)),
+                             "value-changed",
+                             G_CALLBACK (vadjustment_value_changed_callback),
+                             view, 0);
 }
 
 static void
@@ -1858,6 +2136,19 @@ fm_list_view_add_file (FMDirectoryView *view, CajaFile *file, CajaDirectory *dir
 
     model = FM_LIST_VIEW (view)->details->model;
     fm_list_model_add_file (model, file, directory);
+
+    schedule_prioritize_visible_files (FM_LIST_VIEW (view));
+}
+
+static void
+fm_list_view_add_files (FMDirectoryView *view, GList *files, CajaDirectory *directory)
+{
+    FMListModel *model;
+
+    model = FM_LIST_VIEW (view)->details->model;
+    fm_list_model_add_files (model, files, directory);
+
+    schedule_prioritize_visible_files (FM_LIST_VIEW (view));
 }
 
 static char **
@@ -3093,6 +3384,12 @@ fm_list_view_dispose (GObject *object)
         list_view->details->renaming_file_activate_timeout = 0;
     }
 
+    if (list_view->details->prioritize_visible_id != 0)
+    {
+        g_source_remove (list_view->details->prioritize_visible_id);
+        list_view->details->prioritize_visible_id = 0;
+    }
+
     if (list_view->details->clipboard_handler_id != 0)
     {
         g_signal_handler_disconnect (caja_clipboard_monitor_get (),
@@ -3129,11 +3426,18 @@ fm_list_view_finalize (GObject *object)
     g_list_free (list_view->details->cells);
     g_hash_table_destroy (list_view->details->columns);
 
+    if (--list_view_count == 0)
+    {
+        release_warm_subdirectories ();
+    }
+
     if (list_view->details->hover_path != NULL)
     {
         gtk_tree_path_free (list_view->details->hover_path);
     }
 
+    caja_file_unref (list_view->details->prefetch_hover_file);
+
     if (list_view->details->column_editor != NULL)
     {
         gtk_widget_destroy (list_view->details->column_editor);
@@ -3326,6 +3630,7 @@ fm_list_view_class_init (FMListViewClass *class)
     G_OBJECT_CLASS (class)->finalize = fm_list_view_finalize;
 
     fm_directory_view_class->add_file = fm_list_view_add_file;
+    fm_directory_view_class->add_files = fm_list_view_add_files;
     fm_directory_view_class->begin_loading = fm_list_view_begin_loading;
     fm_directory_view_class->end_loading = fm_list_view_end_loading;
     fm_directory_view_class->bump_zoom_level = fm_list_view_bump_zoom_level;
@@ -3400,6 +3705,7 @@ static void
 fm_list_view_init (FMListView *list_view)
 {
     list_view->details = g_new0 (FMListViewDetails, 1);
+    list_view_count++;
 
     create_and_set_up_tree_view (list_view);
 